@@ -1,22 +1,36 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "core/candle_series.hpp"
 #include "core/types.hpp"
 #include "strategy/composite_strategy.hpp"
 
 namespace lwti {
 
+class StateReader;
+class StateWriter;
+
 struct BacktestConfig {
   double starting_equity{100000.0};
   double risk_per_trade{0.02};    // fraction of equity to allocate per signal
   double fee_bps{1.0};            // commission in basis points per trade
   double slippage_bps{1.0};       // execution slippage in basis points
+  bool keep_trade_log{true};      // off: only trade counts are kept (bounded memory)
+  // Above zero: closes are rounded to int64 ticks of this size, positions
+  // are whole lots of lot_size units and equity and costs are kept in int64
+  // (one unit = one tick on one lot), so results are bit-reproducible.
+  // The starting equity must fit in 2^53 units (see fixed_ledger_fits());
+  // a session given one that does not keeps a double ledger.
+  double tick_size{0.0};
+  double lot_size{1.0};
 };
 
 struct Trade {
-  std::string timestamp;
+  Timestamp timestamp{0};
   Signal signal{Signal::Flat};
   double price{0.0};
   double quantity{0.0};
@@ -34,11 +48,84 @@ struct BacktestResult {
 
 class Backtester {
  public:
+  // Bar-by-bar simulation. Memory grows only with the trade log, not with
+  // the number of bars.
+  class Session {
+   public:
+    explicit Session(const BacktestConfig& config);
+    void update(const Candle& candle, const StrategyPoint& point);
+    void update(Timestamp timestamp, double close, const StrategyPoint& point);
+    // A close already in ticks; only for a session with a tick size.
+    void update_ticks(Timestamp timestamp, std::int64_t close_ticks, const StrategyPoint& point);
+    // Closes any open position at the last bar and returns the summary.
+    BacktestResult finish() const;
+    // Checkpoint for follow mode; restore() fails on state saved under a
+    // different config.
+    void save(StateWriter& out) const;
+    bool restore(StateReader& in);
+
+   private:
+    BacktestConfig config_;
+    std::size_t bars_{0};
+    double equity_{0.0};
+    double peak_{0.0};
+    double max_drawdown_{0.0};
+    double position_qty_{0.0};  // number of units
+    double trade_entry_equity_{0.0};
+    Signal trade_signal_{Signal::Flat};
+    std::vector<Trade> log_;
+    std::size_t trades_{0};
+    std::size_t wins_{0};
+    double prev_close_{0.0};
+    Timestamp last_timestamp_{0};
+
+    // Fixed-point ledger; equity_, position_qty_ and prev_close_ mirror it
+    // in double for the summary.
+    struct Ledger {
+      std::int64_t cash{0};
+      std::int64_t peak{0};
+      std::int64_t lots{0};
+      std::int64_t entry_cash{0};
+      std::int64_t prev_ticks{0};
+    };
+    bool fixed() const { return config_.tick_size > 0.0; }
+    double cash_value(std::int64_t cash) const {
+      return static_cast<double>(cash) * config_.tick_size * config_.lot_size;
+    }
+    Ledger ledger_;
+    std::int64_t cost_rate_{0};  // fee + slippage per 1e8 of notional
+  };
+
   explicit Backtester(BacktestConfig config = {});
+
+  // False when a tick size is set but the starting equity is too large to
+  // count in ticks on one lot; callers reject such a config up front.
+  bool fixed_ledger_fits() const;
+  // Accounting is in double unless the config sets a tick size; float
+  // strategy points are widened per bar.
+  template <typename Scalar>
   BacktestResult run(const std::vector<Candle>& candles,
-                     const std::vector<StrategyPoint>& strategy) const;
+                     const std::vector<BasicStrategyPoint<Scalar>>& strategy) const;
+  template <typename Scalar>
+  BacktestResult run(const CandleSeries& series,
+                     const std::vector<BasicStrategyPoint<Scalar>>& strategy) const;
+  // Over caller-owned columns; covers the shortest span. Plain overloads,
+  // so vectors and mutable spans convert without naming the span type.
+  BacktestResult run(std::span<const Timestamp> timestamp, std::span<const double> close,
+                     std::span<const StrategyPoint> strategy) const;
+  BacktestResult run(std::span<const Timestamp> timestamp, std::span<const double> close,
+                     std::span<const BasicStrategyPoint<float>> strategy) const;
+  // Fixed-point run at the series' tick and lot size.
+  template <typename Scalar>
+  BacktestResult run(const FixedCandleSeries& series,
+                     const std::vector<BasicStrategyPoint<Scalar>>& strategy) const;
+  Session session() const { return Session(config_); }
 
  private:
+  template <typename Scalar>
+  BacktestResult run_columns(std::span<const Timestamp> timestamp, std::span<const double> close,
+                             std::span<const BasicStrategyPoint<Scalar>> strategy) const;
+
   BacktestConfig config_;
 };
 
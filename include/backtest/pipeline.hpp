@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+#include "backtest/backtester.hpp"
+#include "config/run_config.hpp"
+#include "core/types.hpp"
+#include "indicator.hpp"
+#include "indicators/regime.hpp"
+#include "indicators/vwap_band.hpp"
+#include "strategy/composite_strategy.hpp"
+
+namespace lwti {
+
+class StateReader;
+class StateWriter;
+
+// Outputs of every stage for one bar.
+struct PipelineStep {
+  IndicatorPoint lwti;
+  VwapBandPoint vwap;
+  RegimePoint regime;
+  StrategyPoint strategy;
+};
+
+// Indicators, strategy and backtest advanced together one bar at a time;
+// state is bounded by the indicator windows (plus the trade log if kept).
+class Pipeline {
+ public:
+  explicit Pipeline(const RunConfig& config);
+
+  PipelineStep update(const Candle& candle);
+  std::size_t bars() const { return bars_; }
+  BacktestResult finish() const { return session_.finish(); }
+
+  // Checkpoint of every stage. A failed restore (corrupt state or a
+  // different config) leaves the pipeline unusable; start a fresh one.
+  void save(StateWriter& out) const;
+  bool restore(StateReader& in);
+
+ private:
+  LiquidityWeightedTrendIndicator::Stream lwti_;
+  VwapBandIndicator::Stream vwap_;
+  VolatilityRegimeIndicator::Stream regime_;
+  CompositeStrategy strategy_;
+  Backtester::Session session_;
+  std::size_t bars_{0};
+};
+
+}  // namespace lwti
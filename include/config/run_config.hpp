@@ -7,14 +7,11 @@
 #include "indicator.hpp"
 #include "indicators/regime.hpp"
 #include "indicators/vwap_band.hpp"
+#include "io/candle_loader.hpp"
 #include "strategy/composite_strategy.hpp"
 
 namespace lwti {
 
-struct DataConfig {
-  std::string input_path;
-};
-
 struct RunConfig {
   DataConfig data;
   IndicatorConfig lwti{};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "core/types.hpp"
+
+namespace lwti {
+
+// Structure-of-arrays candle storage: one contiguous column per field, so
+// a loop over closes and volumes streams through just those two arrays
+// instead of striding over whole Candle records.
+struct CandleSeries {
+  std::vector<Timestamp> timestamp;
+  std::vector<double> open;
+  std::vector<double> high;
+  std::vector<double> low;
+  std::vector<double> close;
+  std::vector<double> volume;
+
+  CandleSeries() = default;
+  explicit CandleSeries(const std::vector<Candle>& candles);
+  // Same, then frees the records, so only the columns stay resident.
+  explicit CandleSeries(std::vector<Candle>&& candles);
+
+  std::size_t size() const { return timestamp.size(); }
+  bool empty() const { return timestamp.empty(); }
+  void reserve(std::size_t rows);
+  void push_back(const Candle& candle);
+
+  // Gathers row i back into a record.
+  Candle operator[](std::size_t i) const {
+    return {timestamp[i], open[i], high[i], low[i], close[i], volume[i]};
+  }
+  std::vector<Candle> to_candles() const;
+};
+
+// Fixed-point copy of a series: prices as int64 counts of tick_size and
+// volumes as int64 counts of lot_size, so sums over it are exact and the
+// same on every compiler and thread count.
+struct FixedCandleSeries {
+  double tick_size{0.0};
+  double lot_size{1.0};
+  std::vector<Timestamp> timestamp;
+  std::vector<std::int64_t> open;
+  std::vector<std::int64_t> high;
+  std::vector<std::int64_t> low;
+  std::vector<std::int64_t> close;
+  std::vector<std::int64_t> volume;
+
+  std::size_t size() const { return timestamp.size(); }
+  bool empty() const { return timestamp.empty(); }
+};
+
+// Rounds every price to the nearest tick and every volume to the nearest
+// lot. std::nullopt when a scale is not positive or a value does not fit
+// (non-finite, or more than 2^53 units).
+std::optional<FixedCandleSeries> to_fixed(const CandleSeries& series, double tick_size,
+                                          double lot_size = 1.0);
+
+}  // namespace lwti
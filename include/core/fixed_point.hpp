@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+
+namespace lwti {
+
+// Rounds value / unit to the nearest whole count of unit. std::nullopt for a
+// non-finite value or a count doubles cannot hold exactly (beyond 2^53).
+inline std::optional<std::int64_t> to_units(double value, double unit) {
+  constexpr double kMaxExact = 9007199254740992.0;  // 2^53
+  const double units = std::nearbyint(value / unit);
+  if (!std::isfinite(units) || std::abs(units) > kMaxExact) {
+    return std::nullopt;
+  }
+  return static_cast<std::int64_t>(units);
+}
+
+// a * b / c truncated toward zero, with a 128-bit intermediate so the
+// product cannot overflow. c must be non-zero.
+inline std::int64_t mul_div(std::int64_t a, std::int64_t b, std::int64_t c) {
+  __extension__ using Wide = __int128;
+  return static_cast<std::int64_t>(static_cast<Wide>(a) * b / c);
+}
+
+}  // namespace lwti
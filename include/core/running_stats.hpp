@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+
+namespace lwti {
+
+// Kahan-compensated running sum. Removing a value from a rolling window is
+// add(-value), so the error stays bounded however many values pass through.
+template <typename T>
+struct CompensatedSum {
+  T sum{0};
+  T carry{0};
+
+  void add(T value) {
+    const T y = value - carry;
+    const T t = sum + y;
+    carry = (t - sum) - y;
+    sum = t;
+  }
+  T value() const { return sum; }
+};
+
+// Welford mean and sum of squared deviations over a rolling window. Unlike
+// sum and sum-of-squares, the variance is never the difference of two
+// large, nearly equal numbers; both terms are also compensated, so a mean
+// far from zero does not drift in float over millions of updates.
+template <typename T>
+struct WindowMoments {
+  CompensatedSum<T> mean;
+  CompensatedSum<T> m2;
+
+  // Adds a value to a window that now holds count values.
+  void push(T value, std::size_t count) {
+    const T delta = deviation(value);
+    mean.add(delta / static_cast<T>(count));
+    m2.add(delta * deviation(value));
+  }
+  // Swaps the oldest value for a new one in a full window of count values.
+  void replace(T removed, T added, std::size_t count) {
+    const T old_removed = deviation(removed);
+    mean.add((added - removed) / static_cast<T>(count));
+    m2.add((added - removed) * (deviation(added) + old_removed));
+  }
+  // value - mean with the mean's carried low bits folded back in.
+  T deviation(T value) const { return (value - mean.sum) + mean.carry; }
+  // Population variance; never negative.
+  T variance(std::size_t count) const {
+    const T v = count > 0 ? m2.value() / static_cast<T>(count) : T{0};
+    return v > T{0} ? v : T{0};
+  }
+};
+
+}  // namespace lwti
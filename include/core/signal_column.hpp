@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/types.hpp"
+
+namespace lwti {
+
+struct SignalCounts {
+  std::size_t long_bars{0};
+  std::size_t short_bars{0};
+  std::size_t flat_bars{0};
+};
+
+// Signals packed two bits per bar, 32 bars to a 64-bit word: flat 00,
+// long 01, short 10. Statistics run a word at a time with popcounts, and
+// unused slots in the last word stay flat.
+class SignalColumn {
+ public:
+  static constexpr std::size_t kBarsPerWord = 32;
+
+  SignalColumn() = default;
+  // size bars, all flat.
+  explicit SignalColumn(std::size_t size);
+  // Adopts packed words holding size bars; slots past size and slots
+  // holding the unused code 3 are cleared to flat.
+  static SignalColumn from_words(std::vector<std::uint64_t> words, std::size_t size);
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  Signal operator[](std::size_t i) const;
+  void set(std::size_t i, Signal signal);
+  void push_back(Signal signal);
+  const std::vector<std::uint64_t>& words() const { return words_; }
+
+  // +1 long, -1 short, 0 flat for every bar.
+  std::vector<std::int8_t> polarity() const;
+  SignalCounts counts() const;
+  // Bars whose signal differs from the bar before; bar 0 never counts.
+  std::size_t transitions() const;
+  std::vector<std::size_t> transition_bars() const;
+
+ private:
+  std::vector<std::uint64_t> words_;
+  std::size_t size_{0};
+};
+
+// Two-bit code of a signal and back; code 3 is unused and reads as flat.
+std::uint64_t signal_code(Signal signal);
+Signal signal_from_code(std::uint64_t code);
+
+// Packs the signal of every point (any stage's output) into a column.
+template <typename Points>
+SignalColumn pack_signals(const Points& points) {
+  SignalColumn column(points.size());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    column.set(i, points[i].signal);
+  }
+  return column;
+}
+
+}  // namespace lwti
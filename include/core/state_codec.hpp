@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace lwti {
+
+// Flat native-endian encoding of checkpointed pipeline state. Values are
+// written field by field, so struct padding never reaches the bytes.
+class StateWriter {
+ public:
+  template <typename T>
+  void put(const T& value) {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+    bytes_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  void put(const std::deque<double>& values);
+  void put(const std::deque<float>& values);
+
+  const std::string& bytes() const { return bytes_; }
+
+ private:
+  std::string bytes_;
+};
+
+// Reads back what StateWriter wrote; every get fails past the end.
+class StateReader {
+ public:
+  explicit StateReader(std::string_view bytes) : bytes_(bytes) {}
+
+  template <typename T>
+  bool get(T& value) {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+    if (bytes_.size() < sizeof(T)) return false;
+    std::memcpy(&value, bytes_.data(), sizeof(T));
+    bytes_.remove_prefix(sizeof(T));
+    return true;
+  }
+  bool get(std::deque<double>& values);
+  bool get(std::deque<float>& values);
+
+  // Reads a value and checks it equals expected (e.g. a saved config field).
+  template <typename T>
+  bool expect(const T& expected) {
+    T value{};
+    return get(value) && value == expected;
+  }
+
+  bool at_end() const { return bytes_.empty(); }
+
+ private:
+  std::string_view bytes_;
+};
+
+// Whole-file helpers; the write goes through a temporary file and rename
+// so a crash never leaves a torn state file.
+std::optional<std::string> read_state_file(const std::string& path);
+bool write_state_file(const std::string& path, const std::string& bytes);
+
+}  // namespace lwti
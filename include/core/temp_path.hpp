@@ -0,0 +1,19 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace lwti {
+
+// Name for the temporary file an atomic write renames over path:
+// "<path>.tmp.<pid>.<n>". Unique per process and call, so concurrent
+// writers of the same target never share (and tear) one temporary.
+inline std::string temp_path_for(const std::string& path) {
+  static std::atomic<std::uint64_t> counter{0};
+  return path + ".tmp." + std::to_string(::getpid()) + "." + std::to_string(counter++);
+}
+
+}  // namespace lwti
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "core/types.hpp"
+
+namespace lwti {
+
+inline constexpr Timestamp kNanosPerSecond = 1'000'000'000;
+
+// Parses ISO-8601 text into UTC epoch nanoseconds. The fixed
+// "YYYY-MM-DDTHH:MM:SSZ" layout takes a branch-light fast path; otherwise
+// accepted forms are a date with optional time ('T' or ' ' separator),
+// optional seconds, up to nine fraction digits and a 'Z' or +HH[:MM]
+// offset (no zone means UTC). Returns false on malformed input.
+bool parse_timestamp(std::string_view text, Timestamp& out);
+
+// Parses a positive duration such as "500ms", "1s", "5m", "1h" or "1d"
+// (units ns, us, ms, s, m, h, d) into nanoseconds.
+bool parse_duration(std::string_view text, Timestamp& out);
+
+// Half-open [from, to) span of timestamps; the default covers everything.
+struct TimeRange {
+  Timestamp from{std::numeric_limits<Timestamp>::min()};
+  Timestamp to{std::numeric_limits<Timestamp>::max()};
+
+  bool bounded() const { return *this != TimeRange{}; }
+  bool contains(Timestamp ts) const { return ts >= from && ts < to; }
+  // True when the closed span [first, last] has a timestamp in range.
+  bool overlaps(Timestamp first, Timestamp last) const { return last >= from && first < to; }
+
+  bool operator==(const TimeRange&) const = default;
+};
+
+// UTC calendar month of ts, e.g. {2024, 3}.
+struct CivilMonth {
+  int year{1970};
+  int month{1};
+
+  auto operator<=>(const CivilMonth&) const = default;
+};
+CivilMonth month_of(Timestamp ts);
+
+// Longest text format_timestamp can produce.
+inline constexpr std::size_t kMaxTimestampChars = 32;
+
+// Writes "YYYY-MM-DDTHH:MM:SS[.fff|.ffffff|.fffffffff]Z" into out (at least
+// kMaxTimestampChars bytes) and returns the length. The fraction is
+// omitted for whole seconds.
+std::size_t format_timestamp(Timestamp ts, char* out);
+std::string format_timestamp(Timestamp ts);
+
+}  // namespace lwti
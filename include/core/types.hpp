@@ -1,12 +1,15 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
 #include <string_view>
 
 namespace lwti {
 
+// UTC epoch nanoseconds; converted to ISO-8601 text only on export.
+using Timestamp = std::int64_t;
+
 struct Candle {
-  std::string timestamp;
+  Timestamp timestamp{0};
   double open{0.0};
   double high{0.0};
   double low{0.0};
@@ -14,6 +17,13 @@ struct Candle {
   double volume{0.0};
 };
 
+// A single trade print.
+struct Tick {
+  Timestamp timestamp{0};
+  double price{0.0};
+  double size{0.0};
+};
+
 enum class Signal { Long, Short, Flat };
 
 std::string_view signal_to_string(Signal signal);
@@ -1,13 +1,83 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "core/time.hpp"
 #include "core/types.hpp"
+#include "io/csv_index.hpp"
+#include "io/structural_scanner.hpp"
 
 namespace lwti {
 
-// Parses CSV with header: timestamp,open,high,low,close,volume.
-std::vector<Candle> read_candles_csv(const std::string& path);
+// Parses CSV with header: timestamp,open,high,low,close,volume (in any
+// order, among any other columns; see plan_from_header).
+// The file is memory-mapped and parsed in place; malformed rows (including
+// timestamps parse_timestamp rejects) are skipped.
+// With threads > 1 (0 = hardware concurrency) the rows are split into
+// line-aligned chunks parsed concurrently; the result matches a serial read.
+std::vector<Candle> read_candles_csv(const std::string& path, std::size_t threads = 1);
+
+// Same, but parses only the byte window of the sidecar index that holds
+// range, split for the threads at indexed row starts; rows outside the
+// range are dropped.
+std::vector<Candle> read_candles_csv(const std::string& path, std::size_t threads,
+                                     const CsvIndex& index, const TimeRange& range);
+
+// One instrument's rows from a long-format file, in file order.
+struct SymbolCandles {
+  std::string symbol;
+  std::vector<Candle> candles;
+};
+
+// Parses a long-format CSV whose header names a symbol column
+// (symbol/ticker/sym/instrument) next to the six candle columns, and
+// partitions the rows into one series per symbol, sorted by symbol. Each
+// of up to threads workers (0 = hardware concurrency) splits its chunk
+// into local per-symbol buffers; the buffers are then concatenated in
+// chunk order, so every series keeps the file order. Empty when the file
+// has no such header.
+std::vector<SymbolCandles> read_symbol_candles_csv(const std::string& path,
+                                                   std::size_t threads = 1);
+
+// Source column of every candle field, compiled once from the header so
+// the row loop extracts only those six columns from wide files.
+struct ColumnPlan {
+  enum Field : std::size_t { kTimestamp, kOpen, kHigh, kLow, kClose, kVolume, kFieldCount };
+
+  std::array<std::size_t, kFieldCount> columns{0, 1, 2, 3, 4, 5};
+  std::size_t min_fields{kFieldCount};  // rows with fewer columns are malformed
+  ColumnSlots slots{identity_slots<kFieldCount>()};
+
+  // Plan for the given field columns; nullopt if a column is out of range.
+  static std::optional<ColumnPlan> from_columns(
+      const std::array<std::size_t, kFieldCount>& columns);
+};
+
+// Compiles a plan from a header line. Column names are matched case
+// insensitively (timestamp/time/datetime/date/ts, open/o, high/h, low/l,
+// close/c, volume/vol/v); nullopt unless all six are present.
+std::optional<ColumnPlan> plan_from_header(std::string_view header);
+
+// Returns where data rows start in [begin, end) and the plan to parse them
+// with. The first line with at least six columns decides: a header with all
+// six names yields its plan, a legacy header ("open" in column 1) or a data
+// row yields the positional plan. resolved is false when no such line
+// exists yet (e.g. a partially filled buffer).
+const char* read_candle_header(const char* begin, const char* end, ColumnPlan& plan,
+                               bool& resolved);
+
+// Parses one row's fields, indexed by ColumnPlan::Field; false when any
+// of them is malformed.
+bool parse_candle_fields(const std::string_view* fields, Candle& candle);
+
+// Parses the header-free lines in [begin, end) and appends the well-formed
+// rows to candles.
+void parse_candle_rows(const char* begin, const char* end, const ColumnPlan& plan,
+                       std::vector<Candle>& candles);
 
 }  // namespace lwti
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <deque>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "core/candle_series.hpp"
+#include "core/running_stats.hpp"
 #include "core/types.hpp"
 
 namespace lwti {
 
+class StateReader;
+class StateWriter;
+
 struct IndicatorConfig {
   std::size_t trend_period{14};
   std::size_t momentum_lookback{5};
@@ -15,23 +22,65 @@ struct IndicatorConfig {
   double volume_floor{1.0};  // minimum weight for low-liquidity bars
 };
 
-struct IndicatorPoint {
-  std::size_t index{};
-  std::string timestamp;
-  double lw_ema{0.0};
-  double momentum{0.0};
-  double volatility{0.0};
+// Output points line up with the input bars by position; a point's time is
+// the bar's entry in the series timestamp column.
+template <typename Scalar>
+struct BasicIndicatorPoint {
+  Scalar lw_ema{0};
+  Scalar momentum{0};
+  Scalar volatility{0};
   Signal signal{Signal::Flat};
 };
 
-class LiquidityWeightedTrendIndicator {
+// The engine is built for Scalar = double and float; bars are read as
+// doubles and narrowed on entry.
+template <typename Scalar>
+class BasicLiquidityWeightedTrendIndicator {
  public:
-  explicit LiquidityWeightedTrendIndicator(IndicatorConfig config = {});
-  std::vector<IndicatorPoint> compute(const std::vector<Candle>& candles) const;
+  using Point = BasicIndicatorPoint<Scalar>;
+
+  // Bar-by-bar evaluation; state is bounded by the configured windows.
+  class Stream {
+   public:
+    explicit Stream(const IndicatorConfig& config);
+    Point update(const Candle& candle);
+    // Same bar passed as the only fields the indicator reads.
+    Point update(double high, double low, double close, double volume);
+    // Checkpoint for follow mode; restore() fails on state saved under a
+    // different config.
+    void save(StateWriter& out) const;
+    bool restore(StateReader& in);
+
+   private:
+    IndicatorConfig config_;
+    Scalar alpha_{0};
+    std::size_t index_{0};
+    std::deque<Scalar> volume_window_;
+    CompensatedSum<Scalar> volume_sum_;
+    std::deque<Scalar> return_window_;
+    WindowMoments<Scalar> returns_;
+    std::deque<Scalar> lw_history_;  // last momentum_lookback + 1 values
+    Scalar prev_tp_{0};
+    Scalar lw_ema_{0};
+  };
+
+  explicit BasicLiquidityWeightedTrendIndicator(IndicatorConfig config = {});
+  std::vector<Point> compute(const std::vector<Candle>& candles) const;
+  std::vector<Point> compute(const CandleSeries& series) const;
+  // Reads caller-owned columns and writes one point per bar into out; only
+  // the window state is allocated. Covers the shortest span and returns the
+  // number of bars written.
+  std::size_t compute(std::span<const double> high, std::span<const double> low,
+                      std::span<const double> close, std::span<const double> volume,
+                      std::span<Point> out) const;
+  Stream stream() const { return Stream(config_); }
   const IndicatorConfig& config() const { return config_; }
 
  private:
   IndicatorConfig config_;
 };
 
+using IndicatorPoint = BasicIndicatorPoint<double>;
+using LiquidityWeightedTrendIndicator = BasicLiquidityWeightedTrendIndicator<double>;
+
 }  // namespace lwti
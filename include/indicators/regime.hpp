@@ -1,12 +1,19 @@
 #pragma once
 
+#include <deque>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "core/candle_series.hpp"
+#include "core/running_stats.hpp"
 #include "core/types.hpp"
 
 namespace lwti {
 
+class StateReader;
+class StateWriter;
+
 enum class VolatilityRegime { Low, High };
 
 struct RegimeConfig {
@@ -14,22 +21,53 @@ struct RegimeConfig {
   double high_vol_threshold{0.02};  // daily return std threshold
 };
 
-struct RegimePoint {
-  std::size_t index{};
-  std::string timestamp;
-  double realized_vol{0.0};
+// Lines up with the input bars by position, like IndicatorPoint.
+template <typename Scalar>
+struct BasicRegimePoint {
+  Scalar realized_vol{0};
   VolatilityRegime regime{VolatilityRegime::Low};
   Signal signal{Signal::Flat};  // flat when high volatility, else neutral long
 };
 
-class VolatilityRegimeIndicator {
+// Built for Scalar = double and float, like the trend indicator.
+template <typename Scalar>
+class BasicVolatilityRegimeIndicator {
  public:
-  explicit VolatilityRegimeIndicator(RegimeConfig config = {});
-  std::vector<RegimePoint> compute(const std::vector<Candle>& candles) const;
+  using Point = BasicRegimePoint<Scalar>;
+
+  // Bar-by-bar evaluation over the rolling return window.
+  class Stream {
+   public:
+    explicit Stream(const RegimeConfig& config) : config_(config) {}
+    Point update(const Candle& candle);
+    Point update(double close);
+    // Checkpoint for follow mode; restore() fails on state saved under a
+    // different config.
+    void save(StateWriter& out) const;
+    bool restore(StateReader& in);
+
+   private:
+    RegimeConfig config_;
+    std::size_t index_{0};
+    std::deque<Scalar> returns_;
+    WindowMoments<Scalar> moments_;
+    Scalar prev_close_{0};
+  };
+
+  explicit BasicVolatilityRegimeIndicator(RegimeConfig config = {});
+  std::vector<Point> compute(const std::vector<Candle>& candles) const;
+  std::vector<Point> compute(const CandleSeries& series) const;
+  // Caller-owned closes in, points written into out; returns the number of
+  // bars written (the shorter span).
+  std::size_t compute(std::span<const double> close, std::span<Point> out) const;
+  Stream stream() const { return Stream(config_); }
   const RegimeConfig& config() const { return config_; }
 
  private:
   RegimeConfig config_;
 };
 
+using RegimePoint = BasicRegimePoint<double>;
+using VolatilityRegimeIndicator = BasicVolatilityRegimeIndicator<double>;
+
 }  // namespace lwti
@@ -1,34 +1,75 @@
 #pragma once
 
+#include <deque>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "core/candle_series.hpp"
+#include "core/running_stats.hpp"
 #include "core/types.hpp"
 
 namespace lwti {
 
+class StateReader;
+class StateWriter;
+
 struct VwapBandConfig {
   std::size_t window{20};
   double band_deviation{1.5};  // standard deviations for bands
 };
 
-struct VwapBandPoint {
-  std::size_t index{};
-  std::string timestamp;
-  double vwap{0.0};
-  double upper{0.0};
-  double lower{0.0};
+// Lines up with the input bars by position, like IndicatorPoint.
+template <typename Scalar>
+struct BasicVwapBandPoint {
+  Scalar vwap{0};
+  Scalar upper{0};
+  Scalar lower{0};
   Signal signal{Signal::Flat};
 };
 
-class VwapBandIndicator {
+// Built for Scalar = double and float, like the trend indicator.
+template <typename Scalar>
+class BasicVwapBandIndicator {
  public:
-  explicit VwapBandIndicator(VwapBandConfig config = {});
-  std::vector<VwapBandPoint> compute(const std::vector<Candle>& candles) const;
+  using Point = BasicVwapBandPoint<Scalar>;
+
+  // Bar-by-bar evaluation over the rolling window.
+  class Stream {
+   public:
+    explicit Stream(const VwapBandConfig& config) : config_(config) {}
+    Point update(const Candle& candle);
+    Point update(double close, double volume);
+    // Checkpoint for follow mode; restore() fails on state saved under a
+    // different config.
+    void save(StateWriter& out) const;
+    bool restore(StateReader& in);
+
+   private:
+    VwapBandConfig config_;
+    std::deque<Scalar> pv_window_;
+    std::deque<Scalar> v_window_;
+    std::deque<Scalar> price_window_;
+    CompensatedSum<Scalar> pv_sum_;
+    CompensatedSum<Scalar> v_sum_;
+    WindowMoments<Scalar> price_;
+  };
+
+  explicit BasicVwapBandIndicator(VwapBandConfig config = {});
+  std::vector<Point> compute(const std::vector<Candle>& candles) const;
+  std::vector<Point> compute(const CandleSeries& series) const;
+  // Caller-owned columns in, points written into out; returns the number
+  // of bars written (the shortest span).
+  std::size_t compute(std::span<const double> close, std::span<const double> volume,
+                      std::span<Point> out) const;
+  Stream stream() const { return Stream(config_); }
   const VwapBandConfig& config() const { return config_; }
 
  private:
   VwapBandConfig config_;
 };
 
+using VwapBandPoint = BasicVwapBandPoint<double>;
+using VwapBandIndicator = BasicVwapBandIndicator<double>;
+
 }  // namespace lwti
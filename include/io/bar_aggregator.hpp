@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "core/types.hpp"
+
+namespace lwti {
+
+// Builds OHLCV bars of one interval from time-ordered ticks or finer bars. Bars are
+// aligned to multiples of the interval since the epoch and stamped with
+// their start time; intervals without ticks produce no bar.
+class BarAggregator {
+ public:
+  explicit BarAggregator(Timestamp interval);
+
+  // Folds a tick into the open bar. Returns true when the tick starts a new
+  // bar, in which case the finished one is written to completed. Ticks
+  // older than the open bar are counted in dropped() and ignored.
+  bool add(const Tick& tick, Candle& completed);
+
+  // Same for a finer bar: first open, max high, min low, last close and
+  // summed volume over the interval.
+  bool add(const Candle& bar, Candle& completed);
+
+  // Hands out the open bar, if any, and resets.
+  bool flush(Candle& completed);
+
+  Timestamp interval() const { return interval_; }
+  std::size_t dropped() const { return dropped_; }
+
+ private:
+  Timestamp bucket_of(Timestamp ts) const;
+
+  Timestamp interval_;
+  Candle bar_{};
+  bool open_{false};
+  std::size_t dropped_{0};
+};
+
+// Rolls time-ordered candles up to a coarser period.
+std::vector<Candle> resample_candles(const std::vector<Candle>& candles, Timestamp period);
+
+}  // namespace lwti
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/time.hpp"
+#include "core/types.hpp"
+#include "io/fingerprint.hpp"
+
+namespace lwti {
+
+// Columnar binary cache of a parsed CSV. Layout (native endian, every
+// section 8-byte aligned):
+//   header (64 bytes): magic, version, rows, source fingerprint, flags
+//   int64 timestamp [rows] (epoch nanoseconds)
+//   double open/high/low/close/volume [rows] each
+std::string candle_cache_path(const std::string& source_path);
+
+// Maps the cache and returns its candles in range if it was built from a
+// source with this fingerprint; std::nullopt when missing, stale or
+// corrupt. A cache of time-sorted rows is binary searched, so only the
+// pages holding the range are touched.
+std::optional<std::vector<Candle>> read_candle_cache(const std::string& cache_path,
+                                                     const SourceFingerprint& source,
+                                                     const TimeRange& range = {});
+
+// Writes the cache atomically (temporary file + rename). Returns false on
+// I/O failure; the caller can carry on without a cache.
+bool write_candle_cache(const std::string& cache_path, const SourceFingerprint& source,
+                        const std::vector<Candle>& candles);
+
+}  // namespace lwti
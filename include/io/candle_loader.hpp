@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/time.hpp"
+#include "core/types.hpp"
+#include "csv_reader.hpp"
+#include "io/candle_source.hpp"
+#include "io/candle_validation.hpp"
+
+namespace lwti {
+
+struct DataConfig {
+  // Files, directories (every *.csv inside) or glob patterns in the file
+  // name, e.g. "data/2023-*.csv". Several inputs are merged by timestamp.
+  // Files ending in ".lwts" are read as compressed candle stores.
+  std::vector<std::string> inputs;
+  std::size_t threads{1};  // CSV parse threads, 0 = hardware concurrency
+  bool stream{false};      // evaluate bar by bar from a bounded read buffer
+  bool cache{true};        // reuse or write the binary cache next to each CSV
+  // Without the cache, reuse or write a sparse row index next to each CSV
+  // so range loads parse only the rows they need.
+  bool csv_index{false};
+  // When set, the inputs hold ticks (timestamp,price,size) and are built
+  // into bars of each interval, e.g. {"1s", "1m", "5m"}.
+  std::vector<std::string> tick_bars;
+  // Rolls loaded candles up to this period (ns) before any indicator runs;
+  // 0 keeps them as they are.
+  Timestamp resample{0};
+  // Only bars in [from, to) are loaded (--from/--to).
+  TimeRange range;
+  // Checkpoint file for tail-follow runs over a CSV that keeps growing;
+  // empty disables follow mode.
+  std::string follow_state;
+  // Checks loaded bars for bad OHLC values and order, and sorts and
+  // deduplicates them when needed (batch loads only).
+  bool validate{false};
+  // The inputs are long-format CSVs with a symbol column; every symbol is
+  // run as its own series.
+  bool by_symbol{false};
+  // Partitioned dataset root to read instead of inputs (see dataset.hpp);
+  // every symbol is run as its own series.
+  std::string dataset;
+  // Symbols to load from a dataset or long-format inputs; empty keeps all.
+  std::vector<std::string> symbols;
+};
+
+// Expands directories and glob patterns into a sorted list of files.
+// Plain paths are kept as given, even if they do not exist.
+std::vector<std::string> resolve_inputs(const std::vector<std::string>& specs);
+
+// Loads the configured inputs. With caching on, a valid "<input>.lwtc" is
+// mapped instead of parsing the CSV, and a missing or stale one is rebuilt
+// after parsing. Several files are loaded in parallel and k-way merged by
+// timestamp; a bar repeating the previous timestamp is dropped, keeping
+// the one from the file listed first. With validation on, the merged
+// series is checked and repaired before it is resampled, and the counts
+// are written to quality when given.
+std::vector<Candle> load_candles(const DataConfig& config, ValidationReport* quality = nullptr);
+
+// Loads long-format inputs, or the dataset when one is configured, as one
+// series per selected symbol, sorted by symbol. A symbol spread over
+// several files is k-way merged like load_candles; a dataset is pruned to
+// the partitions overlapping the range. Each series is trimmed to the
+// range, validated and resampled as configured; quality, when given, gets
+// one report per series.
+std::vector<SymbolCandles> load_symbol_candles(const DataConfig& config,
+                                               std::vector<ValidationReport>* quality = nullptr);
+
+struct SymbolSource {
+  std::string symbol;
+  std::unique_ptr<CandleSource> source;
+};
+
+// Bounded-memory sources over the configured dataset, one per selected
+// symbol with partitions in range, sorted by symbol (resampled when
+// configured). Partition stores are only mapped while they are read.
+std::vector<SymbolSource> open_dataset_sources(const DataConfig& config);
+
+// Bounded-memory source over the configured inputs (merged when several,
+// resampled when configured).
+// Returns nullptr when an input cannot be opened.
+std::unique_ptr<CandleSource> open_candle_source(const DataConfig& config);
+
+// Builds bars of every interval from the tick inputs in a single pass; the
+// result is parallel to intervals.
+std::vector<std::vector<Candle>> load_tick_bars(const DataConfig& config,
+                                                const std::vector<Timestamp>& intervals);
+
+// Bounded-memory bars of one interval built from the tick inputs.
+std::unique_ptr<CandleSource> open_tick_bar_source(const DataConfig& config, Timestamp interval);
+
+}  // namespace lwti
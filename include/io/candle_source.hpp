@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/time.hpp"
+#include "core/types.hpp"
+#include "csv_reader.hpp"
+#include "io/bar_aggregator.hpp"
+#include "io/line_reader.hpp"
+
+namespace lwti {
+
+// Pull-style producer of candles in time order, consumed batch by batch.
+class CandleSource {
+ public:
+  virtual ~CandleSource() = default;
+
+  // Replaces batch with the next candles. Returns false once exhausted.
+  virtual bool next(std::vector<Candle>& batch) = 0;
+};
+
+// Where reading of a growing CSV stopped, so a later run can resume.
+struct CsvPosition {
+  std::uint64_t offset{0};  // always at the start of a line
+  bool header_resolved{false};
+  ColumnPlan plan;
+};
+
+// Reads a CSV file through a fixed-size buffer, so memory stays bounded
+// regardless of file length. Parsing rules match read_candles_csv.
+class CsvCandleSource : public CandleSource {
+ public:
+  explicit CsvCandleSource(const std::string& path,
+                           std::size_t buffer_bytes = LineReader::kDefaultBufferBytes);
+
+  // Resumes a file that is still being appended to. Only newline-terminated
+  // rows are read; an unterminated last row waits for the next run.
+  CsvCandleSource(const std::string& path, const CsvPosition& from,
+                  std::size_t buffer_bytes = LineReader::kDefaultBufferBytes);
+
+  bool is_open() const { return reader_.is_open(); }
+  bool next(std::vector<Candle>& batch) override;
+
+  // Resume point after the batches read so far.
+  CsvPosition position() const { return {reader_.offset(), header_resolved_, plan_}; }
+
+ private:
+  LineReader reader_;
+  bool header_resolved_{false};
+  ColumnPlan plan_;
+};
+
+// k-way merge of several time-ordered sources by timestamp. On a timestamp
+// several sources share, the source listed first wins and the others' bars
+// are dropped; repeats within one source are kept, as for a single input.
+class MergedCandleSource : public CandleSource {
+ public:
+  static constexpr std::size_t kBatchSize = 4096;
+
+  explicit MergedCandleSource(std::vector<std::unique_ptr<CandleSource>> sources);
+
+  bool next(std::vector<Candle>& batch) override;
+
+ private:
+  struct Input {
+    std::unique_ptr<CandleSource> source;
+    std::vector<Candle> batch;
+    std::size_t pos{0};
+  };
+  bool refill(Input& input);
+
+  std::vector<Input> inputs_;
+  std::vector<std::size_t> heap_;  // indices into inputs_, earliest head on top
+  bool started_{false};
+  bool emitted_{false};
+  Timestamp last_{0};
+  std::size_t owner_{0};  // input that first emitted last_
+};
+
+// Passes on only the bars of another source that fall in range.
+class RangeCandleSource : public CandleSource {
+ public:
+  RangeCandleSource(std::unique_ptr<CandleSource> source, const TimeRange& range);
+
+  bool next(std::vector<Candle>& batch) override;
+
+ private:
+  std::unique_ptr<CandleSource> source_;
+  TimeRange range_;
+};
+
+// Rolls the bars of another source up to a coarser period on the fly.
+class ResampledCandleSource : public CandleSource {
+ public:
+  ResampledCandleSource(std::unique_ptr<CandleSource> source, Timestamp period);
+
+  bool next(std::vector<Candle>& batch) override;
+
+ private:
+  std::unique_ptr<CandleSource> source_;
+  BarAggregator aggregator_;
+  std::vector<Candle> input_;
+  bool done_{false};
+};
+
+}  // namespace lwti
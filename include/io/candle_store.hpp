@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/time.hpp"
+#include "core/types.hpp"
+#include "io/candle_source.hpp"
+#include "io/mapped_file.hpp"
+
+namespace lwti {
+
+// Compressed candle archive (".lwts"). Rows are split into blocks that
+// decode on their own:
+//   file header (48 bytes): magic, version, rows, blocks, index offset
+//   per block: header (rows, payload bytes, first timestamp, scales) and
+//   payload of LEB128 varints:
+//     timestamps as zigzag delta-of-delta,
+//     open/high/low/close as zigzag deltas of price * 10^scale,
+//     volume as zigzag volume * 10^scale.
+//   block index: one StoreBlockInfo per block
+// The index gives every block's offset and zone map, so time-range loads
+// decode only the blocks they overlap.
+// Each price/volume column picks the smallest decimal scale that
+// reproduces every value in the block exactly; columns without one are
+// stored as raw doubles, so the format is lossless.
+inline constexpr const char* kStoreExtension = ".lwts";
+inline constexpr std::size_t kStoreBlockRows = 4096;
+
+// Index entry of one block: where it starts and the min/max of its
+// timestamp, close and volume columns.
+struct StoreBlockInfo {
+  std::uint64_t offset{0};
+  std::uint64_t rows{0};
+  Timestamp min_timestamp{0};
+  Timestamp max_timestamp{0};
+  double min_close{0.0};
+  double max_close{0.0};
+  double min_volume{0.0};
+  double max_volume{0.0};
+};
+
+// True when the path names a store (by extension).
+bool is_candle_store(const std::string& path);
+
+// Writes the store atomically (temporary file + rename), block_rows
+// (clamped to 1..kStoreBlockRows) rows per block. Returns false on I/O
+// failure.
+bool write_candle_store(const std::string& path, const std::vector<Candle>& candles,
+                        std::size_t block_rows = kStoreBlockRows);
+
+// Decodes the candles in range, reading only the blocks whose zone map
+// overlaps it; std::nullopt when missing or corrupt.
+std::optional<std::vector<Candle>> read_candle_store(const std::string& path,
+                                                     const TimeRange& range = {});
+
+// The block index alone; std::nullopt when missing or corrupt.
+std::optional<std::vector<StoreBlockInfo>> read_store_index(const std::string& path);
+
+// Decodes one overlapping block per batch from the mapped store. Pages of
+// blocks already decoded are released, so memory stays bounded however
+// large the store is.
+class StoreCandleSource : public CandleSource {
+ public:
+  explicit StoreCandleSource(const std::string& path, const TimeRange& range = {});
+
+  bool is_open() const { return valid_; }
+  bool next(std::vector<Candle>& batch) override;
+
+ private:
+  MappedFile file_;
+  TimeRange range_;
+  std::vector<StoreBlockInfo> index_;
+  std::uint64_t index_offset_{0};
+  std::size_t next_block_{0};
+  std::uint64_t released_{0};  // bytes before this are no longer needed
+  std::vector<std::int64_t> scratch_;
+  bool valid_{false};
+};
+
+}  // namespace lwti
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "core/types.hpp"
+
+namespace lwti {
+
+// Data-quality counts over a candle series. Counts are of bars: a bar with
+// two non-positive prices adds one to zero_price.
+struct ValidationReport {
+  std::size_t rows{0};
+  std::size_t bad_high{0};         // high below max(open, close)
+  std::size_t bad_low{0};          // low above min(open, close)
+  std::size_t negative_volume{0};  // volume below zero
+  std::size_t zero_price{0};       // an open/high/low/close that is zero or negative
+  std::size_t non_finite{0};       // a NaN or infinite field
+  std::size_t out_of_order{0};     // bar stamped earlier than the one before it
+  std::size_t duplicates{0};       // bar repeating an earlier timestamp
+
+  std::size_t issues() const {
+    return bad_high + bad_low + negative_volume + zero_price + non_finite + out_of_order +
+           duplicates;
+  }
+};
+
+// Runs every check in one branch-free pass over the series; the AVX2
+// build of the pass is picked at runtime when the CPU has it. Duplicates
+// are counted against the previous bar only.
+ValidationReport check_candles(const std::vector<Candle>& candles);
+
+// Stable-sorts the bars by timestamp on up to threads workers (0 = hardware
+// concurrency) and drops every bar repeating a timestamp, keeping the first
+// in input order. Returns the number of bars dropped.
+std::size_t repair_candles(std::vector<Candle>& candles, std::size_t threads);
+
+// Checks the series and repairs its order when needed. The report holds
+// the counts found before the repair, with duplicates set to the number of
+// bars the repair dropped.
+ValidationReport validate_candles(std::vector<Candle>& candles, std::size_t threads);
+
+}  // namespace lwti
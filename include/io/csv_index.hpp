@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/time.hpp"
+#include "core/types.hpp"
+#include "io/fingerprint.hpp"
+
+namespace lwti {
+
+struct CsvIndexEntry {
+  std::uint64_t offset;  // start of the row's line
+  Timestamp timestamp;
+};
+
+// Sparse index over the rows of a raw CSV: the byte offset and timestamp
+// of every stride-th row whose timestamp parses. Persisted next to the
+// CSV as "<csv>.lwtx":
+//   header (64 bytes): magic, version, source fingerprint, stride, count, flags
+//   {uint64 offset, int64 timestamp} [count]
+struct CsvIndex {
+  static constexpr std::uint64_t kDefaultStride = 1024;
+
+  std::uint64_t stride{kDefaultStride};
+  bool sorted{false};  // every row's timestamp is non-decreasing
+  std::vector<CsvIndexEntry> entries;
+
+  // Byte window [first, last) of a file of file_size bytes that holds
+  // every row in range. A sorted index narrows it to the rows between
+  // the bracketing entries; otherwise it is the whole file.
+  std::pair<std::uint64_t, std::uint64_t> window(const TimeRange& range,
+                                                 std::uint64_t file_size) const;
+
+  // Bounds of up to parts slices of [first, last) for parallel parsing,
+  // first and last included. Every inner bound is an indexed row start.
+  std::vector<std::uint64_t> splits(std::uint64_t first, std::uint64_t last,
+                                    std::size_t parts) const;
+};
+
+std::string csv_index_path(const std::string& csv_path);
+
+// One pass over the rows in [data, data + size), which hold a whole CSV
+// file including its header.
+CsvIndex build_csv_index(const char* data, std::size_t size,
+                         std::uint64_t stride = CsvIndex::kDefaultStride);
+
+// std::nullopt when missing, stale or corrupt.
+std::optional<CsvIndex> read_csv_index(const std::string& index_path,
+                                       const SourceFingerprint& source);
+
+// Writes the index atomically (temporary file + rename).
+bool write_csv_index(const std::string& index_path, const SourceFingerprint& source,
+                     const CsvIndex& index);
+
+// Reuses "<csv>.lwtx" if it matches the CSV's sampled fingerprint,
+// otherwise builds and writes it. std::nullopt when the CSV cannot be read.
+std::optional<CsvIndex> load_csv_index(const std::string& csv_path);
+
+}  // namespace lwti
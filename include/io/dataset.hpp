@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/time.hpp"
+#include "csv_reader.hpp"
+#include "io/candle_source.hpp"
+#include "io/candle_store.hpp"
+
+namespace lwti {
+
+// A dataset is a directory of compressed candle stores, one per symbol
+// and calendar month, with a catalog of what each partition holds:
+//   <root>/catalog.lwtd
+//   <root>/<symbol>/<yyyy>/<mm>.lwts
+// Catalog layout (native endian): a 32-byte header (magic, version,
+// count), then count 64-byte entries sorted by symbol and month.
+struct DatasetPartition {
+  static constexpr std::size_t kMaxSymbolChars = 31;
+
+  std::string symbol;
+  CivilMonth month;
+  std::uint64_t rows{0};
+  Timestamp first{0};  // earliest and latest timestamp in the partition
+  Timestamp last{0};
+};
+
+// True when the symbol can name a directory or file suffix: not empty, at
+// most kMaxSymbolChars, no '/' and not "." or "..".
+bool valid_symbol(const std::string& symbol);
+
+std::string dataset_catalog_path(const std::string& root);
+std::string dataset_partition_path(const std::string& root, const DatasetPartition& partition);
+
+// std::nullopt when the catalog is missing or corrupt.
+std::optional<std::vector<DatasetPartition>> read_dataset_catalog(const std::string& root);
+
+// Splits every series by month and writes the partitions on up to
+// threads workers (0 = hardware concurrency), then rewrites the catalog.
+// Partitions already in the dataset for other symbols or months are
+// kept; those written here replace their old version. Returns false on
+// I/O failure or a symbol that is empty, too long or holds a '/'.
+bool write_dataset(const std::string& root, const std::vector<SymbolCandles>& series,
+                   std::size_t threads);
+
+// Catalog entries of the given symbols (all when empty) whose time span
+// overlaps range, in catalog order.
+std::vector<DatasetPartition> prune_partitions(const std::vector<DatasetPartition>& catalog,
+                                               const std::vector<std::string>& symbols,
+                                               const TimeRange& range);
+
+// Reads the pruned partitions in parallel (each store also skips blocks
+// outside range) and joins them into one series per symbol, sorted by
+// symbol. Empty when the catalog is missing; a partition that fails to
+// read is left out.
+std::vector<SymbolCandles> load_dataset(const std::string& root,
+                                        const std::vector<std::string>& symbols,
+                                        const TimeRange& range, std::size_t threads);
+
+// Streams the given partitions (one symbol's, in month order) block by
+// block, mapping a single partition store at a time. Partitions that fail
+// to open are skipped, as in load_dataset.
+class DatasetCandleSource : public CandleSource {
+ public:
+  DatasetCandleSource(std::string root, std::vector<DatasetPartition> partitions,
+                      const TimeRange& range);
+
+  bool next(std::vector<Candle>& batch) override;
+
+ private:
+  std::string root_;
+  std::vector<DatasetPartition> partitions_;
+  TimeRange range_;
+  std::size_t next_partition_{0};
+  std::unique_ptr<StoreCandleSource> current_;
+};
+
+}  // namespace lwti
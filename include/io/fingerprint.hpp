@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace lwti {
+
+// Identity of a source file, used to invalidate derived files (caches,
+// indexes) when the source changes.
+struct SourceFingerprint {
+  std::uint64_t size{0};
+  std::int64_t mtime_ns{0};
+  std::uint64_t hash{0};
+
+  bool operator==(const SourceFingerprint&) const = default;
+};
+
+// 64-bit content hash; reads eight bytes at a time over four lanes.
+std::uint64_t hash_bytes(const char* data, std::size_t size);
+
+// Size and modification time only; cheap, no content is read.
+std::optional<SourceFingerprint> stat_fingerprint(const std::string& path);
+
+// Size, modification time and a hash of the first and last 64 KiB; for
+// caches and sidecar files that exist to avoid reading the whole source.
+std::optional<SourceFingerprint> sampled_fingerprint(const std::string& path);
+
+}  // namespace lwti
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "io/read_ahead.hpp"
+
+namespace lwti {
+
+// Reads a file through a fixed-size buffer and hands out runs of complete
+// lines. A line longer than the whole buffer is dropped as malformed. The
+// disk reads run ahead on a separate thread (see ReadAhead).
+class LineReader {
+ public:
+  static constexpr std::size_t kDefaultBufferBytes = 1 << 20;
+
+  // Reading starts at byte offset start. With complete_only, an unterminated
+  // last line is never handed out (a writer may still be appending to it).
+  explicit LineReader(const std::string& path, std::size_t buffer_bytes = kDefaultBufferBytes,
+                      std::uint64_t start = 0, bool complete_only = false,
+                      ReadAhead::Backend backend = ReadAhead::Backend::kAuto);
+
+  bool is_open() const { return input_.is_open(); }
+
+  // Points [begin, end) at the next run of complete lines (the last line
+  // may lack its newline at end of file). The range stays valid until the
+  // next call. Returns false once the input is exhausted.
+  bool next(const char*& begin, const char*& end);
+
+  // File offset just past the lines handed out so far.
+  std::uint64_t offset() const { return position_ + consumed_; }
+
+ private:
+  ReadAhead input_;
+  std::vector<char> buffer_;
+  std::size_t filled_{0};    // bytes at the front of buffer_ not handed out
+  std::size_t consumed_{0};  // bytes handed out by the previous call
+  std::uint64_t position_{0};  // file offset of buffer_[0]
+  bool complete_only_{false};
+  bool eof_{false};
+  bool skipping_line_{false};  // inside a line longer than the buffer
+};
+
+}  // namespace lwti
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace lwti {
+
+// Read-only memory mapping of a whole file. Empty files open successfully
+// with an empty view; failures leave the object closed (is_open() == false).
+class MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool is_open() const { return open_; }
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  std::string_view view() const { return {data_, size_}; }
+
+  // Drops the whole pages inside [offset, offset + length) from this
+  // process, so a mapping read front to back keeps only the pages ahead
+  // of the reader resident. Touching them again faults them back in.
+  void release(std::size_t offset, std::size_t length) const;
+
+ private:
+  void reset();
+
+  const char* data_{nullptr};
+  std::size_t size_{0};
+  bool open_{false};
+};
+
+}  // namespace lwti
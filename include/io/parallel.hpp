@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace lwti {
+
+// Worker count for `work` units when each worker should get at least
+// min_per_worker of them. requested == 0 means one per hardware thread.
+inline std::size_t resolve_workers(std::size_t requested, std::size_t work,
+                                   std::size_t min_per_worker = 1) {
+  std::size_t threads = requested;
+  if (threads == 0) {
+    threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }
+  return std::clamp<std::size_t>(work / min_per_worker, 1, threads);
+}
+
+// Runs job(i) for every i < count on up to threads workers, the calling
+// thread included. Items are handed out one at a time from a shared counter.
+template <typename Job>
+void run_parallel(std::size_t count, std::size_t threads, Job&& job) {
+  const std::size_t workers = resolve_workers(threads, count);
+  std::atomic<std::size_t> next{0};
+  auto work = [&] {
+    for (std::size_t i = next++; i < count; i = next++) {
+      job(i);
+    }
+  };
+  std::vector<std::thread> pool;
+  for (std::size_t w = 1; w < workers; ++w) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (auto& worker : pool) {
+    worker.join();
+  }
+}
+
+}  // namespace lwti
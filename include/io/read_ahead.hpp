@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace lwti {
+
+// Sequential file reader whose I/O runs on a dedicated thread. The thread
+// keeps a ring of aligned chunks filled ahead of the consumer, so disk
+// latency overlaps with parsing. Reads go through io_uring (all free
+// chunks in flight at once) when the kernel allows it, and pread
+// otherwise. The file is read up to its size at open time.
+class ReadAhead {
+ public:
+  enum class Backend { kAuto, kPread };
+
+  static constexpr std::size_t kDefaultChunkBytes = 1 << 20;
+  static constexpr std::size_t kDefaultDepth = 4;
+
+  explicit ReadAhead(const std::string& path, std::uint64_t start = 0,
+                     Backend backend = Backend::kAuto,
+                     std::size_t chunk_bytes = kDefaultChunkBytes,
+                     std::size_t depth = kDefaultDepth);
+  ~ReadAhead();
+
+  ReadAhead(const ReadAhead&) = delete;
+  ReadAhead& operator=(const ReadAhead&) = delete;
+
+  bool is_open() const { return fd_ >= 0; }
+
+  // Copies the next bytes into out, blocking until size bytes are
+  // available or the file ends. Returns the count copied (short at end).
+  std::size_t read(char* out, std::size_t size);
+
+  // "io_uring" or "pread".
+  std::string_view backend() const;
+
+ private:
+  struct Chunk {
+    char* data{nullptr};
+    std::uint64_t offset{0};
+    std::size_t want{0};   // bytes requested
+    std::size_t bytes{0};  // bytes read so far
+    std::size_t taken{0};  // bytes handed to the consumer
+    bool ready{false};
+    bool busy{false};
+  };
+  struct AlignedFree {
+    void operator()(char* p) const;
+  };
+  struct Uring;
+  struct UringDelete {
+    void operator()(Uring* p) const;
+  };
+
+  void run_pread();
+  void run_uring();
+  // Claims the next free chunk in ring order (mutex_ held); false when none
+  // is free, at end of file or when stopping.
+  bool claim(std::size_t& index);
+  void publish(std::size_t index);
+  void pread_fill(Chunk& chunk);
+
+  int fd_{-1};
+  std::uint64_t size_{0};
+  std::uint64_t next_offset_{0};
+  std::size_t chunk_bytes_{0};
+  std::unique_ptr<char, AlignedFree> memory_;
+  std::unique_ptr<Uring, UringDelete> uring_;
+  std::vector<Chunk> ring_;
+  std::size_t head_{0};  // next chunk for the consumer
+  std::size_t tail_{0};  // next chunk for the reader thread
+  bool truncated_{false};
+  bool stop_{false};
+  bool done_{false};  // consumer side: end of data reached
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::thread thread_;
+};
+
+}  // namespace lwti
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace lwti {
+
+inline constexpr std::size_t kScanBlock = 64;
+
+// Bit i of each mask is set when byte i of the block is that delimiter.
+struct StructuralMasks {
+  std::uint64_t comma{0};
+  std::uint64_t newline{0};
+};
+
+using BlockScanner = StructuralMasks (*)(const char* block);
+
+// Classifier for one 64-byte block. Uses AVX2 or SSE2 when the CPU has them
+// (resolved once at startup) and a scalar loop otherwise.
+BlockScanner block_scanner();
+
+inline StructuralMasks scan_block(const char* block) { return block_scanner()(block); }
+
+// Name of the backend scan_block dispatches to: "avx2", "sse2" or "scalar".
+std::string_view scanner_backend();
+
+// Routes source columns to field slots: slots[c] is the slot that column c
+// fills, kSkipColumn for columns nobody reads. Columns past the map are
+// always skipped.
+inline constexpr std::size_t kMaxMappedColumns = 64;
+inline constexpr std::uint8_t kSkipColumn = 0xFF;
+using ColumnSlots = std::array<std::uint8_t, kMaxMappedColumns>;
+
+template <std::size_t N>
+constexpr ColumnSlots identity_slots() {
+  ColumnSlots slots{};
+  for (std::size_t c = 0; c < kMaxMappedColumns; ++c) {
+    slots[c] = c < N ? static_cast<std::uint8_t>(c) : kSkipColumn;
+  }
+  return slots;
+}
+
+// Calls on_row(line, fields, field_count) for every line in [begin, end),
+// with fields[s] holding the (untrimmed) column routed to slot s and
+// field_count the total number of columns on the line. Lines are located
+// from the block masks, so the bytes between delimiters are never
+// inspected here and skipped columns cost one table lookup.
+template <std::size_t N, typename RowFn>
+void for_each_row(const char* begin, const char* end, const ColumnSlots& slots,
+                  RowFn&& on_row) {
+  std::array<std::string_view, N> fields{};
+  std::size_t field = 0;
+  const char* line_start = begin;
+  const char* field_start = begin;
+
+  auto close_field = [&](const char* pos) {
+    const std::uint8_t slot = field < kMaxMappedColumns ? slots[field] : kSkipColumn;
+    if (slot != kSkipColumn) {
+      fields[slot] = std::string_view(field_start, static_cast<std::size_t>(pos - field_start));
+    }
+    ++field;
+    field_start = pos + 1;
+  };
+  auto close_line = [&](const char* pos) {
+    close_field(pos);
+    on_row(std::string_view(line_start, static_cast<std::size_t>(pos - line_start)), fields,
+           field);
+    field = 0;
+    line_start = pos + 1;
+  };
+
+  auto consume = [&](const char* base, StructuralMasks masks) {
+    std::uint64_t bits = masks.comma | masks.newline;
+    while (bits != 0) {
+      const int offset = __builtin_ctzll(bits);
+      const std::uint64_t bit = bits & (~bits + 1);
+      bits ^= bit;
+      if ((masks.newline & bit) != 0) {
+        close_line(base + offset);
+      } else {
+        close_field(base + offset);
+      }
+    }
+  };
+
+  const BlockScanner scan = block_scanner();
+  const char* block = begin;
+  for (; static_cast<std::size_t>(end - block) >= kScanBlock; block += kScanBlock) {
+    consume(block, scan(block));
+  }
+  if (block < end) {
+    // Pad the tail so the scanner never reads past the range.
+    alignas(kScanBlock) char tail[kScanBlock];
+    const std::size_t rest = static_cast<std::size_t>(end - block);
+    std::memcpy(tail, block, rest);
+    std::memset(tail + rest, ' ', kScanBlock - rest);
+    StructuralMasks masks = scan(tail);
+    const std::uint64_t valid = (std::uint64_t{1} << rest) - 1;
+    masks.comma &= valid;
+    masks.newline &= valid;
+    consume(block, masks);
+  }
+  if (line_start < end) {
+    close_line(end);
+  }
+}
+
+// Same as above with the first N columns routed to slots 0..N-1.
+template <std::size_t N, typename RowFn>
+void for_each_row(const char* begin, const char* end, RowFn&& on_row) {
+  static constexpr ColumnSlots kSlots = identity_slots<N>();
+  for_each_row<N>(begin, end, kSlots, std::forward<RowFn>(on_row));
+}
+
+}  // namespace lwti
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/types.hpp"
+#include "io/bar_aggregator.hpp"
+#include "io/candle_source.hpp"
+#include "io/line_reader.hpp"
+#include "io/structural_scanner.hpp"
+
+namespace lwti {
+
+// Incremental parser for tick CSVs: timestamp,price,size. A header may
+// name the columns in any order (timestamp/time/ts, price/px/last,
+// size/qty/volume/amount); without one the layout is positional.
+// Malformed rows are skipped.
+class TickParser {
+ public:
+  // Parses the complete lines in [begin, end), calling on_tick(const Tick&)
+  // for every well-formed row.
+  template <typename TickFn>
+  void parse(const char* begin, const char* end, TickFn&& on_tick);
+
+ private:
+  enum Field : std::size_t { kTimestamp, kPrice, kSize, kFieldCount };
+
+  // Consumes the header if [begin, end) holds the first non-empty line;
+  // returns where data rows start.
+  const char* resolve_header(const char* begin, const char* end);
+  static bool parse_row(const std::array<std::string_view, kFieldCount>& fields, Tick& tick);
+
+  bool resolved_{false};
+  std::size_t min_fields_{kFieldCount};
+  ColumnSlots slots_{identity_slots<kFieldCount>()};
+};
+
+template <typename TickFn>
+void TickParser::parse(const char* begin, const char* end, TickFn&& on_tick) {
+  if (!resolved_) {
+    begin = resolve_header(begin, end);
+  }
+  Tick tick;
+  for_each_row<kFieldCount>(begin, end, slots_,
+                            [&](std::string_view line, const auto& fields, std::size_t count) {
+                              if (!line.empty() && count >= min_fields_ &&
+                                  parse_row(fields, tick)) {
+                                on_tick(tick);
+                              }
+                            });
+}
+
+// Reads the tick files in order in a single pass and returns one bar
+// series per interval.
+std::vector<std::vector<Candle>> aggregate_tick_files(const std::vector<std::string>& paths,
+                                                      const std::vector<Timestamp>& intervals);
+
+// Bounded-memory bars of one interval built from tick files read in order.
+class TickBarSource : public CandleSource {
+ public:
+  TickBarSource(std::vector<std::string> paths, Timestamp interval,
+                std::size_t buffer_bytes = LineReader::kDefaultBufferBytes);
+
+  bool next(std::vector<Candle>& batch) override;
+
+ private:
+  std::vector<std::string> paths_;
+  std::size_t next_path_{0};
+  std::size_t buffer_bytes_;
+  std::unique_ptr<LineReader> reader_;
+  TickParser parser_;
+  BarAggregator aggregator_;
+  bool flushed_{false};
+};
+
+}  // namespace lwti
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 
+#include "core/signal_column.hpp"
 #include "core/types.hpp"
 #include "indicator.hpp"
 #include "indicators/regime.hpp"
@@ -16,23 +18,52 @@ struct CompositeStrategyConfig {
   double max_position{1.0};  // fraction of equity
 };
 
-struct StrategyPoint {
-  std::size_t index{};
-  std::string timestamp;
-  double score{0.0};
-  double position{0.0};
+// Lines up with the input bars by position, like IndicatorPoint.
+template <typename Scalar>
+struct BasicStrategyPoint {
+  Scalar score{0};
+  Scalar position{0};
   Signal signal{Signal::Flat};
 };
 
-class CompositeStrategy {
+// Combines indicator points of the same Scalar (double or float).
+template <typename Scalar>
+class BasicCompositeStrategy {
  public:
-  explicit CompositeStrategy(CompositeStrategyConfig config = {});
-  std::vector<StrategyPoint> generate(const std::vector<IndicatorPoint>& lwti_points,
-                                      const std::vector<VwapBandPoint>& vwap_points,
-                                      const std::vector<RegimePoint>& regimes) const;
+  using Point = BasicStrategyPoint<Scalar>;
+
+  explicit BasicCompositeStrategy(CompositeStrategyConfig config = {});
+  std::vector<Point> generate(const std::vector<BasicIndicatorPoint<Scalar>>& lwti_points,
+                              const std::vector<BasicVwapBandPoint<Scalar>>& vwap_points,
+                              const std::vector<BasicRegimePoint<Scalar>>& regimes) const;
+  // Writes into caller-owned out without allocating; returns the number of
+  // bars written (the shortest span).
+  std::size_t generate(std::span<const BasicIndicatorPoint<Scalar>> lwti_points,
+                       std::span<const BasicVwapBandPoint<Scalar>> vwap_points,
+                       std::span<const BasicRegimePoint<Scalar>> regimes,
+                       std::span<Point> out) const;
+  // Same scoring from packed signal columns. The regime column is flat
+  // where volatility is high, as RegimePoint::signal is.
+  std::vector<Point> generate(const SignalColumn& lwti_signals, const SignalColumn& vwap_signals,
+                              const SignalColumn& regime_signals) const;
+  // Only the strategy's signals, packed; no per-bar points are built.
+  SignalColumn signals(const SignalColumn& lwti_signals, const SignalColumn& vwap_signals,
+                       const SignalColumn& regime_signals) const;
+  // Scores a single bar; generate() applies this to every index.
+  Point evaluate(const BasicIndicatorPoint<Scalar>& lwti_point,
+                 const BasicVwapBandPoint<Scalar>& vwap_point,
+                 const BasicRegimePoint<Scalar>& regime) const;
+  const CompositeStrategyConfig& config() const { return config_; }
 
  private:
+  // Point for each of the 64 combinations of the three 2-bit codes,
+  // indexed lwti | vwap << 2 | regime << 4.
+  std::vector<Point> score_table() const;
+
   CompositeStrategyConfig config_;
 };
 
+using StrategyPoint = BasicStrategyPoint<double>;
+using CompositeStrategy = BasicCompositeStrategy<double>;
+
 }  // namespace lwti
@@ -2,94 +2,321 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+
+#include "core/fixed_point.hpp"
+#include "core/state_codec.hpp"
 
 namespace lwti {
+namespace {
+
+template <typename Scalar>
+StrategyPoint widen(const BasicStrategyPoint<Scalar>& point) {
+  return {point.score, point.position, point.signal};
+}
+
+constexpr std::int64_t kWeightScale = 1'000'000;   // target weight in ppm
+constexpr std::int64_t kCostScale = 100'000'000;   // cost rate per 1e8 of notional
+
+}  // namespace
 
 Backtester::Backtester(BacktestConfig config) : config_(config) {
   config_.starting_equity = std::max(1000.0, config_.starting_equity);
   config_.risk_per_trade = std::clamp(config_.risk_per_trade, 0.0, 1.0);
   config_.fee_bps = std::max(0.0, config_.fee_bps);
   config_.slippage_bps = std::max(0.0, config_.slippage_bps);
+  config_.tick_size = std::max(0.0, config_.tick_size);
+  config_.lot_size = config_.lot_size > 0.0 ? config_.lot_size : 1.0;
 }
 
+template <typename Scalar>
 BacktestResult Backtester::run(const std::vector<Candle>& candles,
-                               const std::vector<StrategyPoint>& strategy) const {
+                               const std::vector<BasicStrategyPoint<Scalar>>& strategy) const {
   const std::size_t n = std::min(candles.size(), strategy.size());
-  if (n < 2) {
-    return {config_.starting_equity, config_.starting_equity, 0.0, 0, 0.0, {}};
+  Session state = session();
+  for (std::size_t i = 0; i < n; ++i) {
+    state.update(candles[i], widen(strategy[i]));
   }
+  return state.finish();
+}
 
-  double equity = config_.starting_equity;
-  double peak = equity;
-  double max_drawdown = 0.0;
-  double position_qty = 0.0;  // number of units
-  double trade_entry_equity = equity;
-  Signal trade_signal = Signal::Flat;
-  std::vector<Trade> log;
-  std::size_t wins = 0;
+template <typename Scalar>
+BacktestResult Backtester::run(const CandleSeries& series,
+                               const std::vector<BasicStrategyPoint<Scalar>>& strategy) const {
+  return run(std::span(series.timestamp), std::span(series.close), std::span(strategy));
+}
 
-  double prev_close = candles.front().close;
+BacktestResult Backtester::run(std::span<const Timestamp> timestamp, std::span<const double> close,
+                               std::span<const StrategyPoint> strategy) const {
+  return run_columns(timestamp, close, strategy);
+}
 
-  for (std::size_t i = 1; i < n; ++i) {
-    const double price = candles[i].close;
-    const double price_change = price - prev_close;
-    equity += position_qty * price_change;
-    prev_close = price;
+BacktestResult Backtester::run(std::span<const Timestamp> timestamp, std::span<const double> close,
+                               std::span<const BasicStrategyPoint<float>> strategy) const {
+  return run_columns(timestamp, close, strategy);
+}
 
-    peak = std::max(peak, equity);
-    if (peak > 0.0) {
-      max_drawdown = std::max(max_drawdown, (peak - equity) / peak);
-    }
+template <typename Scalar>
+BacktestResult Backtester::run_columns(std::span<const Timestamp> timestamp,
+                                       std::span<const double> close,
+                                       std::span<const BasicStrategyPoint<Scalar>> strategy) const {
+  const std::size_t n = std::min({timestamp.size(), close.size(), strategy.size()});
+  Session state = session();
+  for (std::size_t i = 0; i < n; ++i) {
+    state.update(timestamp[i], close[i], widen(strategy[i]));
+  }
+  return state.finish();
+}
 
-    const auto& s = strategy[i];
-    double target_value = equity * config_.risk_per_trade * s.position;
-    double target_qty = price != 0.0 ? target_value / price : 0.0;
+template <typename Scalar>
+BacktestResult Backtester::run(const FixedCandleSeries& series,
+                               const std::vector<BasicStrategyPoint<Scalar>>& strategy) const {
+  BacktestConfig config = config_;
+  config.tick_size = series.tick_size;
+  config.lot_size = series.lot_size;
+  const std::size_t n = std::min(series.size(), strategy.size());
+  Session state = Backtester(config).session();
+  for (std::size_t i = 0; i < n; ++i) {
+    state.update_ticks(series.timestamp[i], series.close[i], widen(strategy[i]));
+  }
+  return state.finish();
+}
 
-    if (std::isnan(target_qty) || std::isinf(target_qty)) {
-      target_qty = 0.0;
-    }
+template BacktestResult Backtester::run(const std::vector<Candle>&,
+                                        const std::vector<BasicStrategyPoint<float>>&) const;
+template BacktestResult Backtester::run(const std::vector<Candle>&,
+                                        const std::vector<BasicStrategyPoint<double>>&) const;
+template BacktestResult Backtester::run(const CandleSeries&,
+                                        const std::vector<BasicStrategyPoint<float>>&) const;
+template BacktestResult Backtester::run(const CandleSeries&,
+                                        const std::vector<BasicStrategyPoint<double>>&) const;
+template BacktestResult Backtester::run(const FixedCandleSeries&,
+                                        const std::vector<BasicStrategyPoint<float>>&) const;
+template BacktestResult Backtester::run(const FixedCandleSeries&,
+                                        const std::vector<BasicStrategyPoint<double>>&) const;
 
-    const double delta_qty = target_qty - position_qty;
-    if (std::abs(delta_qty) > 1e-9) {
-      const double trade_notional = std::abs(delta_qty) * price;
-      const double cost =
-          trade_notional * (config_.fee_bps + config_.slippage_bps) / 10000.0;
-      equity -= cost;
+bool Backtester::fixed_ledger_fits() const {
+  return config_.tick_size == 0.0 ||
+         to_units(config_.starting_equity, config_.tick_size * config_.lot_size).has_value();
+}
+
+Backtester::Session::Session(const BacktestConfig& config)
+    : config_(config),
+      equity_(config.starting_equity),
+      peak_(config.starting_equity),
+      trade_entry_equity_(config.starting_equity) {
+  if (!fixed()) return;
+  const auto cash = to_units(config_.starting_equity, config_.tick_size * config_.lot_size);
+  if (!cash) {
+    config_.tick_size = 0.0;
+    return;
+  }
+  ledger_.cash = ledger_.peak = ledger_.entry_cash = *cash;
+  cost_rate_ = std::llround((config_.fee_bps + config_.slippage_bps) * 1e4);
+}
+
+void Backtester::Session::update(const Candle& candle, const StrategyPoint& s) {
+  update(candle.timestamp, candle.close, s);
+}
+
+void Backtester::Session::update(Timestamp timestamp, double close, const StrategyPoint& s) {
+  if (fixed()) {
+    // A close that cannot be counted in ticks (NaN, absurd size) is skipped.
+    if (const auto ticks = to_units(close, config_.tick_size)) {
+      update_ticks(timestamp, *ticks, s);
     }
+    return;
+  }
+  const std::size_t i = bars_++;
+  last_timestamp_ = timestamp;
+  if (i == 0) {
+    // The first bar only sets the reference price; trading starts on the next.
+    prev_close_ = close;
+    return;
+  }
+
+  const double price = close;
+  const double price_change = price - prev_close_;
+  equity_ += position_qty_ * price_change;
+  prev_close_ = price;
+
+  peak_ = std::max(peak_, equity_);
+  if (peak_ > 0.0) {
+    max_drawdown_ = std::max(max_drawdown_, (peak_ - equity_) / peak_);
+  }
 
-    const bool closing = position_qty != 0.0 &&
-                         (target_qty == 0.0 || (position_qty * target_qty < 0.0));
-    if (closing) {
-      const double trade_pnl = equity - trade_entry_equity;
-      log.push_back({candles[i].timestamp, trade_signal, price, position_qty, trade_pnl});
-      if (trade_pnl > 0.0) {
-        ++wins;
-      }
+  double target_value = equity_ * config_.risk_per_trade * s.position;
+  double target_qty = price != 0.0 ? target_value / price : 0.0;
+
+  if (std::isnan(target_qty) || std::isinf(target_qty)) {
+    target_qty = 0.0;
+  }
+
+  const double delta_qty = target_qty - position_qty_;
+  if (std::abs(delta_qty) > 1e-9) {
+    const double trade_notional = std::abs(delta_qty) * price;
+    const double cost = trade_notional * (config_.fee_bps + config_.slippage_bps) / 10000.0;
+    equity_ -= cost;
+  }
+
+  const bool closing = position_qty_ != 0.0 &&
+                       (target_qty == 0.0 || (position_qty_ * target_qty < 0.0));
+  if (closing) {
+    const double trade_pnl = equity_ - trade_entry_equity_;
+    if (config_.keep_trade_log) {
+      log_.push_back({timestamp, trade_signal_, price, position_qty_, trade_pnl});
+    }
+    ++trades_;
+    if (trade_pnl > 0.0) {
+      ++wins_;
     }
+  }
+
+  const bool opening = target_qty != 0.0 &&
+                       (position_qty_ == 0.0 || (position_qty_ * target_qty < 0.0));
+  if (opening) {
+    trade_entry_equity_ = equity_;
+    trade_signal_ = s.signal;
+  }
+
+  position_qty_ = target_qty;
+}
 
-    const bool opening = target_qty != 0.0 &&
-                         (position_qty == 0.0 || (position_qty * target_qty < 0.0));
-    if (opening) {
-      trade_entry_equity = equity;
-      trade_signal = s.signal;
+void Backtester::Session::update_ticks(Timestamp timestamp, std::int64_t ticks,
+                                       const StrategyPoint& s) {
+  if (!fixed()) return;
+  const std::size_t i = bars_++;
+  last_timestamp_ = timestamp;
+  prev_close_ = static_cast<double>(ticks) * config_.tick_size;
+  if (i == 0) {
+    ledger_.prev_ticks = ticks;
+    return;
+  }
+
+  Ledger& l = ledger_;
+  l.cash += l.lots * (ticks - l.prev_ticks);
+  l.prev_ticks = ticks;
+  l.peak = std::max(l.peak, l.cash);
+  if (l.peak > 0) {
+    max_drawdown_ = std::max(max_drawdown_, static_cast<double>(l.peak - l.cash) /
+                                                static_cast<double>(l.peak));
+  }
+
+  // Whole lots worth equity * risk * position at this close, toward zero.
+  const std::int64_t weight = std::llround(config_.risk_per_trade * s.position * kWeightScale);
+  const std::int64_t target = ticks > 0 ? mul_div(l.cash, weight, ticks) / kWeightScale : 0;
+  const std::int64_t delta = target - l.lots;
+  if (delta != 0) {
+    // Cost rounded to the nearest unit, half up.
+    l.cash -= (mul_div(std::abs(delta) * ticks, 2 * cost_rate_, kCostScale) + 1) / 2;
+  }
+
+  const bool closing = l.lots != 0 && (target == 0 || (l.lots < 0) != (target < 0));
+  if (closing) {
+    const std::int64_t trade_pnl = l.cash - l.entry_cash;
+    if (config_.keep_trade_log) {
+      log_.push_back({timestamp, trade_signal_, prev_close_,
+                      static_cast<double>(l.lots) * config_.lot_size, cash_value(trade_pnl)});
     }
+    ++trades_;
+    if (trade_pnl > 0) {
+      ++wins_;
+    }
+  }
 
-    position_qty = target_qty;
+  const bool opening = target != 0 && (l.lots == 0 || (l.lots < 0) != (target < 0));
+  if (opening) {
+    l.entry_cash = l.cash;
+    trade_signal_ = s.signal;
   }
 
-  if (position_qty != 0.0) {
-    const double trade_pnl = equity - trade_entry_equity;
-    log.push_back({candles[n - 1].timestamp, trade_signal, candles[n - 1].close,
-                   position_qty, trade_pnl});
-    if (trade_pnl > 0.0) {
+  l.lots = target;
+  equity_ = cash_value(l.cash);
+  position_qty_ = static_cast<double>(l.lots) * config_.lot_size;
+}
+
+BacktestResult Backtester::Session::finish() const {
+  if (bars_ < 2) {
+    return {config_.starting_equity, config_.starting_equity, 0.0, 0, 0.0, {}};
+  }
+
+  std::vector<Trade> log = log_;
+  std::size_t trades = trades_;
+  std::size_t wins = wins_;
+  if (position_qty_ != 0.0) {
+    const std::int64_t fixed_pnl = ledger_.cash - ledger_.entry_cash;
+    const double trade_pnl = fixed() ? cash_value(fixed_pnl) : equity_ - trade_entry_equity_;
+    if (config_.keep_trade_log) {
+      log.push_back({last_timestamp_, trade_signal_, prev_close_, position_qty_, trade_pnl});
+    }
+    ++trades;
+    if (fixed() ? fixed_pnl > 0 : trade_pnl > 0.0) {
       ++wins;
     }
   }
 
-  const std::size_t trades = log.size();
   const double win_rate = trades > 0 ? static_cast<double>(wins) / trades : 0.0;
 
-  return {config_.starting_equity, equity, max_drawdown, trades, win_rate, log};
+  return {config_.starting_equity, equity_, max_drawdown_, trades, win_rate, log};
+}
+
+void Backtester::Session::save(StateWriter& out) const {
+  out.put(config_.starting_equity);
+  out.put(config_.risk_per_trade);
+  out.put(config_.fee_bps);
+  out.put(config_.slippage_bps);
+  out.put(config_.keep_trade_log);
+  out.put(config_.tick_size);
+  out.put(config_.lot_size);
+  out.put(bars_);
+  out.put(equity_);
+  out.put(peak_);
+  out.put(max_drawdown_);
+  out.put(position_qty_);
+  out.put(trade_entry_equity_);
+  out.put(trade_signal_);
+  out.put(trades_);
+  out.put(wins_);
+  out.put(prev_close_);
+  out.put(last_timestamp_);
+  out.put(ledger_.cash);
+  out.put(ledger_.peak);
+  out.put(ledger_.lots);
+  out.put(ledger_.entry_cash);
+  out.put(ledger_.prev_ticks);
+  out.put(static_cast<std::uint64_t>(log_.size()));
+  for (const Trade& t : log_) {
+    out.put(t.timestamp);
+    out.put(t.signal);
+    out.put(t.price);
+    out.put(t.quantity);
+    out.put(t.pnl);
+  }
+}
+
+bool Backtester::Session::restore(StateReader& in) {
+  std::uint64_t log_size = 0;
+  if (!(in.expect(config_.starting_equity) && in.expect(config_.risk_per_trade) &&
+        in.expect(config_.fee_bps) && in.expect(config_.slippage_bps) &&
+        in.expect(config_.keep_trade_log) && in.expect(config_.tick_size) &&
+        in.expect(config_.lot_size) && in.get(bars_) && in.get(equity_) && in.get(peak_) &&
+        in.get(max_drawdown_) && in.get(position_qty_) && in.get(trade_entry_equity_) &&
+        in.get(trade_signal_) && in.get(trades_) && in.get(wins_) && in.get(prev_close_) &&
+        in.get(last_timestamp_) && in.get(ledger_.cash) && in.get(ledger_.peak) &&
+        in.get(ledger_.lots) && in.get(ledger_.entry_cash) && in.get(ledger_.prev_ticks) &&
+        in.get(log_size))) {
+    return false;
+  }
+  log_.clear();
+  for (std::uint64_t i = 0; i < log_size; ++i) {
+    Trade t;
+    if (!(in.get(t.timestamp) && in.get(t.signal) && in.get(t.price) && in.get(t.quantity) &&
+          in.get(t.pnl))) {
+      return false;
+    }
+    log_.push_back(t);
+  }
+  return true;
 }
 
 }  // namespace lwti
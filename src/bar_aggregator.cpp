@@ -0,0 +1,69 @@
+#include "io/bar_aggregator.hpp"
+
+#include <algorithm>
+
+namespace lwti {
+
+BarAggregator::BarAggregator(Timestamp interval) : interval_(std::max<Timestamp>(1, interval)) {}
+
+Timestamp BarAggregator::bucket_of(Timestamp ts) const {
+  Timestamp bucket = ts / interval_ * interval_;
+  if (bucket > ts) {
+    bucket -= interval_;  // floor for times before the epoch
+  }
+  return bucket;
+}
+
+bool BarAggregator::add(const Tick& tick, Candle& completed) {
+  return add(Candle{tick.timestamp, tick.price, tick.price, tick.price, tick.price, tick.size},
+             completed);
+}
+
+bool BarAggregator::add(const Candle& bar, Candle& completed) {
+  const Timestamp bucket = bucket_of(bar.timestamp);
+  if (open_ && bucket == bar_.timestamp) {
+    bar_.high = std::max(bar_.high, bar.high);
+    bar_.low = std::min(bar_.low, bar.low);
+    bar_.close = bar.close;
+    bar_.volume += bar.volume;
+    return false;
+  }
+  if (open_ && bucket < bar_.timestamp) {
+    ++dropped_;
+    return false;
+  }
+  const bool finished = open_;
+  if (finished) {
+    completed = bar_;
+  }
+  bar_ = bar;
+  bar_.timestamp = bucket;
+  open_ = true;
+  return finished;
+}
+
+bool BarAggregator::flush(Candle& completed) {
+  if (!open_) {
+    return false;
+  }
+  completed = bar_;
+  open_ = false;
+  return true;
+}
+
+std::vector<Candle> resample_candles(const std::vector<Candle>& candles, Timestamp period) {
+  BarAggregator aggregator(period);
+  std::vector<Candle> bars;
+  Candle completed;
+  for (const auto& candle : candles) {
+    if (aggregator.add(candle, completed)) {
+      bars.push_back(completed);
+    }
+  }
+  if (aggregator.flush(completed)) {
+    bars.push_back(completed);
+  }
+  return bars;
+}
+
+}  // namespace lwti
@@ -0,0 +1,147 @@
+#include "io/candle_cache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "core/temp_path.hpp"
+#include "io/mapped_file.hpp"
+
+namespace lwti {
+namespace {
+
+constexpr char kMagic[8] = {'L', 'W', 'T', 'I', 'C', 'O', 'L', '\0'};
+constexpr std::uint32_t kVersion = 2;  // v1 stored timestamps as text
+constexpr std::uint32_t kEndianTag = 0x01020304;
+constexpr std::uint64_t kSortedFlag = 1;  // timestamps are non-decreasing
+
+struct CacheHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t endian_tag;
+  std::uint64_t rows;
+  std::uint64_t source_size;
+  std::int64_t source_mtime_ns;
+  std::uint64_t source_hash;
+  std::uint64_t flags;  // zero in caches written before flags existed
+  std::uint64_t reserved;
+};
+static_assert(sizeof(CacheHeader) == 64);
+
+constexpr std::size_t kNumericColumns = 5;
+
+std::size_t expected_size(std::uint64_t rows) {
+  return sizeof(CacheHeader) + rows * sizeof(Timestamp) + kNumericColumns * rows * sizeof(double);
+}
+
+template <typename T>
+void write_column(std::ofstream& out, const std::vector<T>& column) {
+  out.write(reinterpret_cast<const char*>(column.data()),
+            static_cast<std::streamsize>(column.size() * sizeof(T)));
+}
+
+}  // namespace
+
+std::string candle_cache_path(const std::string& source_path) { return source_path + ".lwtc"; }
+
+std::optional<std::vector<Candle>> read_candle_cache(const std::string& cache_path,
+                                                     const SourceFingerprint& source,
+                                                     const TimeRange& range) {
+  const MappedFile file(cache_path);
+  if (!file.is_open() || file.size() < sizeof(CacheHeader)) {
+    return std::nullopt;
+  }
+  CacheHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+      header.endian_tag != kEndianTag) {
+    return std::nullopt;
+  }
+  if (header.source_size != source.size || header.source_mtime_ns != source.mtime_ns ||
+      header.source_hash != source.hash) {
+    return std::nullopt;
+  }
+  const std::size_t rows = header.rows;
+  if (file.size() != expected_size(rows)) {
+    return std::nullopt;
+  }
+
+  // The mapping is page aligned and every section is 8-byte aligned.
+  const char* cursor = file.data() + sizeof(CacheHeader);
+  const auto* timestamps = reinterpret_cast<const Timestamp*>(cursor);
+  cursor += rows * sizeof(Timestamp);
+  const double* columns[kNumericColumns];
+  for (auto& column : columns) {
+    column = reinterpret_cast<const double*>(cursor);
+    cursor += rows * sizeof(double);
+  }
+
+  std::size_t first = 0;
+  std::size_t last = rows;
+  if (range.bounded() && (header.flags & kSortedFlag) != 0) {
+    first = static_cast<std::size_t>(
+        std::lower_bound(timestamps, timestamps + rows, range.from) - timestamps);
+    last = static_cast<std::size_t>(
+        std::lower_bound(timestamps + first, timestamps + rows, range.to) - timestamps);
+  }
+
+  std::vector<Candle> candles;
+  candles.reserve(last - first);
+  for (std::size_t i = first; i < last; ++i) {
+    if (!range.contains(timestamps[i])) continue;
+    candles.push_back({timestamps[i], columns[0][i], columns[1][i], columns[2][i],
+                       columns[3][i], columns[4][i]});
+  }
+  return candles;
+}
+
+bool write_candle_cache(const std::string& cache_path, const SourceFingerprint& source,
+                        const std::vector<Candle>& candles) {
+  const std::size_t rows = candles.size();
+  std::vector<Timestamp> timestamps(rows);
+  std::vector<double> column(rows);
+  for (std::size_t i = 0; i < rows; ++i) {
+    timestamps[i] = candles[i].timestamp;
+  }
+
+  CacheHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endian_tag = kEndianTag;
+  header.rows = rows;
+  header.source_size = source.size;
+  header.source_mtime_ns = source.mtime_ns;
+  header.source_hash = source.hash;
+  header.flags = std::is_sorted(timestamps.begin(), timestamps.end()) ? kSortedFlag : 0;
+
+  const std::string tmp_path = temp_path_for(cache_path);
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_column(out, timestamps);
+    for (double Candle::*field : {&Candle::open, &Candle::high, &Candle::low, &Candle::close,
+                                  &Candle::volume}) {
+      for (std::size_t i = 0; i < rows; ++i) {
+        column[i] = candles[i].*field;
+      }
+      write_column(out, column);
+    }
+    if (!out) {
+      out.close();
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace lwti
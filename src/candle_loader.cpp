@@ -0,0 +1,316 @@
+#include "io/candle_loader.hpp"
+
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <queue>
+#include <utility>
+
+#include "csv_reader.hpp"
+#include "io/candle_cache.hpp"
+#include "io/candle_store.hpp"
+#include "io/csv_index.hpp"
+#include "io/dataset.hpp"
+#include "io/fingerprint.hpp"
+#include "io/parallel.hpp"
+#include "io/tick_reader.hpp"
+
+namespace lwti {
+namespace {
+
+namespace fs = std::filesystem;
+
+bool is_glob(const std::string& spec) {
+  return spec.find_first_of("*?[") != std::string::npos;
+}
+
+// Files in dir whose name matches pattern (all *.csv when pattern is empty).
+std::vector<std::string> list_dir(const fs::path& dir, const std::string& pattern) {
+  std::vector<std::string> files;
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(dir, ec)) {
+    if (!entry.is_regular_file(ec)) continue;
+    const std::string name = entry.path().filename().string();
+    const bool match = pattern.empty() ? entry.path().extension() == ".csv"
+                                       : ::fnmatch(pattern.c_str(), name.c_str(), 0) == 0;
+    if (match) files.push_back(entry.path().string());
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+void keep_range(std::vector<Candle>& candles, const TimeRange& range) {
+  if (range.bounded()) {
+    candles.erase(std::remove_if(candles.begin(), candles.end(),
+                                 [&](const Candle& c) { return !range.contains(c.timestamp); }),
+                  candles.end());
+  }
+}
+
+// Stores, sorted caches and CSVs with a sorted sidecar index seek to the
+// range; otherwise a CSV is parsed in full and then trimmed (its cache is
+// always built from the whole file).
+std::vector<Candle> load_file(const std::string& path, std::size_t threads,
+                              const DataConfig& config) {
+  const TimeRange& range = config.range;
+  if (is_candle_store(path)) {
+    return read_candle_store(path, range).value_or(std::vector<Candle>{});
+  }
+  if (!config.cache) {
+    if (config.csv_index) {
+      if (const auto index = load_csv_index(path)) {
+        return read_candles_csv(path, threads, *index, range);
+      }
+    }
+    auto candles = read_candles_csv(path, threads);
+    keep_range(candles, range);
+    return candles;
+  }
+
+  const auto source = sampled_fingerprint(path);
+  if (!source) {
+    return {};
+  }
+  const std::string cache_path = candle_cache_path(path);
+  if (auto cached = read_candle_cache(cache_path, *source, range)) {
+    return std::move(*cached);
+  }
+
+  auto candles = read_candles_csv(path, threads);
+  if (!candles.empty()) {
+    write_candle_cache(cache_path, *source, candles);
+  }
+  keep_range(candles, range);
+  return candles;
+}
+
+// k-way merge of per-file candles. A timestamp already supplied by an
+// earlier-listed file is dropped; repeats within one file are kept, so a
+// file gives the same bars alone or merged with others.
+std::vector<Candle> merge_by_timestamp(const std::vector<std::vector<Candle>>& parts) {
+  struct Head {
+    Timestamp timestamp;
+    std::size_t part;
+    std::size_t pos;
+  };
+  auto later = [](const Head& a, const Head& b) {
+    return a.timestamp != b.timestamp ? a.timestamp > b.timestamp : a.part > b.part;
+  };
+  std::priority_queue<Head, std::vector<Head>, decltype(later)> heap(later);
+
+  std::size_t total = 0;
+  for (std::size_t p = 0; p < parts.size(); ++p) {
+    total += parts[p].size();
+    if (!parts[p].empty()) heap.push({parts[p].front().timestamp, p, 0});
+  }
+
+  std::vector<Candle> merged;
+  merged.reserve(total);
+  std::size_t owner = 0;  // part that first supplied merged.back()'s timestamp
+  while (!heap.empty()) {
+    const Head head = heap.top();
+    heap.pop();
+    const auto& part = parts[head.part];
+    if (merged.empty() || merged.back().timestamp != head.timestamp) {
+      owner = head.part;
+      merged.push_back(part[head.pos]);
+    } else if (head.part == owner) {
+      merged.push_back(part[head.pos]);  // a repeat within one file is kept
+    }
+    if (head.pos + 1 < part.size()) {
+      heap.push({part[head.pos + 1].timestamp, head.part, head.pos + 1});
+    }
+  }
+  return merged;
+}
+
+}  // namespace
+
+std::vector<std::string> resolve_inputs(const std::vector<std::string>& specs) {
+  std::vector<std::string> files;
+  for (const auto& spec : specs) {
+    std::error_code ec;
+    if (fs::is_directory(spec, ec)) {
+      const auto listed = list_dir(spec, "");
+      files.insert(files.end(), listed.begin(), listed.end());
+    } else if (is_glob(spec)) {
+      const fs::path path(spec);
+      const fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+      const auto listed = list_dir(dir, path.filename().string());
+      files.insert(files.end(), listed.begin(), listed.end());
+    } else {
+      files.push_back(spec);
+    }
+  }
+  return files;
+}
+
+namespace {
+
+std::vector<Candle> load_inputs(const DataConfig& config) {
+  const auto files = resolve_inputs(config.inputs);
+  if (files.empty()) {
+    return {};
+  }
+  if (files.size() == 1) {
+    return load_file(files.front(), config.threads, config);
+  }
+
+  std::vector<std::vector<Candle>> parts(files.size());
+  run_parallel(files.size(), config.threads,
+               [&](std::size_t f) { parts[f] = load_file(files[f], 1, config); });
+  return merge_by_timestamp(parts);
+}
+
+std::unique_ptr<CandleSource> open_inputs(const DataConfig& config) {
+  const auto files = resolve_inputs(config.inputs);
+  std::vector<std::unique_ptr<CandleSource>> sources;
+  for (const auto& file : files) {
+    if (is_candle_store(file)) {
+      auto source = std::make_unique<StoreCandleSource>(file, config.range);
+      if (!source->is_open()) {
+        return nullptr;
+      }
+      sources.push_back(std::move(source));
+      continue;
+    }
+    auto source = std::make_unique<CsvCandleSource>(file);
+    if (!source->is_open()) {
+      return nullptr;
+    }
+    if (config.range.bounded()) {
+      sources.push_back(std::make_unique<RangeCandleSource>(std::move(source), config.range));
+      continue;
+    }
+    sources.push_back(std::move(source));
+  }
+  if (sources.empty()) {
+    return nullptr;
+  }
+  if (sources.size() == 1) {
+    return std::move(sources.front());
+  }
+  return std::make_unique<MergedCandleSource>(std::move(sources));
+}
+
+}  // namespace
+
+std::vector<Candle> load_candles(const DataConfig& config, ValidationReport* quality) {
+  auto candles = load_inputs(config);
+  if (config.validate) {
+    const ValidationReport report = validate_candles(candles, config.threads);
+    if (quality) *quality = report;
+  }
+  if (config.resample > 0) {
+    candles = resample_candles(candles, config.resample);
+  }
+  return candles;
+}
+
+std::vector<SymbolCandles> load_symbol_candles(const DataConfig& config,
+                                               std::vector<ValidationReport>* quality) {
+  std::vector<std::vector<SymbolCandles>> files;
+  if (!config.dataset.empty()) {
+    files.push_back(load_dataset(config.dataset, config.symbols, config.range, config.threads));
+  } else {
+    for (const auto& path : resolve_inputs(config.inputs)) {
+      auto file = read_symbol_candles_csv(path, config.threads);
+      if (!config.symbols.empty()) {
+        std::erase_if(file, [&](const SymbolCandles& s) {
+          return std::find(config.symbols.begin(), config.symbols.end(), s.symbol) ==
+                 config.symbols.end();
+        });
+      }
+      files.push_back(std::move(file));
+    }
+  }
+
+  std::vector<SymbolCandles> out;
+  if (files.size() == 1) {
+    out = std::move(files.front());
+  } else {
+    std::vector<std::string> names;
+    for (const auto& file : files) {
+      for (const auto& part : file) names.push_back(part.symbol);
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    for (auto& name : names) {
+      std::vector<std::vector<Candle>> parts;
+      for (auto& file : files) {
+        const auto it = std::lower_bound(
+            file.begin(), file.end(), name,
+            [](const SymbolCandles& s, const std::string& key) { return s.symbol < key; });
+        if (it != file.end() && it->symbol == name) parts.push_back(std::move(it->candles));
+      }
+      out.push_back({std::move(name), merge_by_timestamp(parts)});
+    }
+  }
+
+  if (quality) quality->clear();
+  for (auto& series : out) {
+    keep_range(series.candles, config.range);
+    if (config.validate) {
+      const ValidationReport report = validate_candles(series.candles, config.threads);
+      if (quality) quality->push_back(report);
+    }
+    if (config.resample > 0) {
+      series.candles = resample_candles(series.candles, config.resample);
+    }
+  }
+  return out;
+}
+
+std::vector<SymbolSource> open_dataset_sources(const DataConfig& config) {
+  std::vector<SymbolSource> sources;
+  const auto catalog = read_dataset_catalog(config.dataset);
+  if (!catalog) {
+    return sources;
+  }
+  const auto partitions = prune_partitions(*catalog, config.symbols, config.range);
+  for (std::size_t i = 0; i < partitions.size();) {
+    std::size_t j = i;
+    while (j < partitions.size() && partitions[j].symbol == partitions[i].symbol) ++j;
+    std::unique_ptr<CandleSource> source = std::make_unique<DatasetCandleSource>(
+        config.dataset,
+        std::vector<DatasetPartition>(partitions.begin() + static_cast<long>(i),
+                                      partitions.begin() + static_cast<long>(j)),
+        config.range);
+    if (config.resample > 0) {
+      source = std::make_unique<ResampledCandleSource>(std::move(source), config.resample);
+    }
+    sources.push_back({partitions[i].symbol, std::move(source)});
+    i = j;
+  }
+  return sources;
+}
+
+std::unique_ptr<CandleSource> open_candle_source(const DataConfig& config) {
+  auto source = open_inputs(config);
+  if (source && config.resample > 0) {
+    source = std::make_unique<ResampledCandleSource>(std::move(source), config.resample);
+  }
+  return source;
+}
+
+// Tick files are read back to back in resolved order (e.g. one file per
+// day), so a shared aggregator carries the open bar across file edges.
+std::vector<std::vector<Candle>> load_tick_bars(const DataConfig& config,
+                                                const std::vector<Timestamp>& intervals) {
+  auto series = aggregate_tick_files(resolve_inputs(config.inputs), intervals);
+  for (auto& bars : series) {
+    keep_range(bars, config.range);
+  }
+  return series;
+}
+
+std::unique_ptr<CandleSource> open_tick_bar_source(const DataConfig& config, Timestamp interval) {
+  auto files = resolve_inputs(config.inputs);
+  if (files.empty()) {
+    return nullptr;
+  }
+  return std::make_unique<TickBarSource>(std::move(files), interval);
+}
+
+}  // namespace lwti
@@ -0,0 +1,86 @@
+#include "core/candle_series.hpp"
+
+#include "core/fixed_point.hpp"
+
+namespace lwti {
+
+CandleSeries::CandleSeries(const std::vector<Candle>& candles) {
+  const std::size_t rows = candles.size();
+  timestamp.resize(rows);
+  open.resize(rows);
+  high.resize(rows);
+  low.resize(rows);
+  close.resize(rows);
+  volume.resize(rows);
+  for (std::size_t i = 0; i < rows; ++i) {
+    const Candle& c = candles[i];
+    timestamp[i] = c.timestamp;
+    open[i] = c.open;
+    high[i] = c.high;
+    low[i] = c.low;
+    close[i] = c.close;
+    volume[i] = c.volume;
+  }
+}
+
+CandleSeries::CandleSeries(std::vector<Candle>&& candles)
+    : CandleSeries(static_cast<const std::vector<Candle>&>(candles)) {
+  std::vector<Candle>().swap(candles);
+}
+
+void CandleSeries::reserve(std::size_t rows) {
+  timestamp.reserve(rows);
+  open.reserve(rows);
+  high.reserve(rows);
+  low.reserve(rows);
+  close.reserve(rows);
+  volume.reserve(rows);
+}
+
+void CandleSeries::push_back(const Candle& candle) {
+  timestamp.push_back(candle.timestamp);
+  open.push_back(candle.open);
+  high.push_back(candle.high);
+  low.push_back(candle.low);
+  close.push_back(candle.close);
+  volume.push_back(candle.volume);
+}
+
+std::vector<Candle> CandleSeries::to_candles() const {
+  std::vector<Candle> candles(size());
+  for (std::size_t i = 0; i < candles.size(); ++i) {
+    candles[i] = (*this)[i];
+  }
+  return candles;
+}
+
+std::optional<FixedCandleSeries> to_fixed(const CandleSeries& series, double tick_size,
+                                          double lot_size) {
+  if (!(tick_size > 0.0) || !(lot_size > 0.0)) {
+    return std::nullopt;
+  }
+  FixedCandleSeries fixed;
+  fixed.tick_size = tick_size;
+  fixed.lot_size = lot_size;
+  fixed.timestamp = series.timestamp;
+  const auto convert = [&](const std::vector<double>& column, double unit,
+                           std::vector<std::int64_t>& out) {
+    out.resize(column.size());
+    for (std::size_t i = 0; i < column.size(); ++i) {
+      const auto units = to_units(column[i], unit);
+      if (!units) return false;
+      out[i] = *units;
+    }
+    return true;
+  };
+  if (!convert(series.open, tick_size, fixed.open) ||
+      !convert(series.high, tick_size, fixed.high) ||
+      !convert(series.low, tick_size, fixed.low) ||
+      !convert(series.close, tick_size, fixed.close) ||
+      !convert(series.volume, lot_size, fixed.volume)) {
+    return std::nullopt;
+  }
+  return fixed;
+}
+
+}  // namespace lwti
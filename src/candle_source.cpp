@@ -0,0 +1,132 @@
+#include "io/candle_source.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "csv_reader.hpp"
+
+namespace lwti {
+
+CsvCandleSource::CsvCandleSource(const std::string& path, std::size_t buffer_bytes)
+    : reader_(path, buffer_bytes) {}
+
+CsvCandleSource::CsvCandleSource(const std::string& path, const CsvPosition& from,
+                                 std::size_t buffer_bytes)
+    : reader_(path, buffer_bytes, from.offset, true),
+      header_resolved_(from.header_resolved),
+      plan_(from.plan) {}
+
+bool CsvCandleSource::next(std::vector<Candle>& batch) {
+  batch.clear();
+  const char* begin = nullptr;
+  const char* end = nullptr;
+  while (batch.empty() && reader_.next(begin, end)) {
+    if (!header_resolved_) {
+      // Lines before the first six-field line are never data rows.
+      const char* body = read_candle_header(begin, end, plan_, header_resolved_);
+      begin = header_resolved_ ? body : end;
+    }
+    parse_candle_rows(begin, end, plan_, batch);
+  }
+  return !batch.empty();
+}
+
+MergedCandleSource::MergedCandleSource(std::vector<std::unique_ptr<CandleSource>> sources) {
+  inputs_.reserve(sources.size());
+  for (auto& source : sources) {
+    inputs_.push_back({std::move(source), {}, 0});
+  }
+}
+
+bool MergedCandleSource::refill(Input& input) {
+  input.pos = 0;
+  while (input.source->next(input.batch)) {
+    if (!input.batch.empty()) {
+      return true;
+    }
+  }
+  input.batch.clear();
+  return false;
+}
+
+bool MergedCandleSource::next(std::vector<Candle>& batch) {
+  // Later on the heap means an earlier (timestamp, input) head.
+  auto later = [this](std::size_t a, std::size_t b) {
+    const Timestamp ta = inputs_[a].batch[inputs_[a].pos].timestamp;
+    const Timestamp tb = inputs_[b].batch[inputs_[b].pos].timestamp;
+    return ta != tb ? ta > tb : a > b;
+  };
+  if (!started_) {
+    started_ = true;
+    for (std::size_t i = 0; i < inputs_.size(); ++i) {
+      if (refill(inputs_[i])) {
+        heap_.push_back(i);
+      }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), later);
+  }
+
+  batch.clear();
+  while (!heap_.empty() && batch.size() < kBatchSize) {
+    std::pop_heap(heap_.begin(), heap_.end(), later);
+    const std::size_t top = heap_.back();
+    Input& input = inputs_[top];
+    const Candle& candle = input.batch[input.pos];
+    if (!emitted_ || candle.timestamp != last_) {
+      batch.push_back(candle);
+      last_ = candle.timestamp;
+      owner_ = top;
+      emitted_ = true;
+    } else if (top == owner_) {
+      batch.push_back(candle);  // a repeat within one source is kept
+    }
+    if (++input.pos < input.batch.size() || refill(input)) {
+      std::push_heap(heap_.begin(), heap_.end(), later);
+    } else {
+      heap_.pop_back();
+    }
+  }
+  return !batch.empty();
+}
+
+RangeCandleSource::RangeCandleSource(std::unique_ptr<CandleSource> source,
+                                     const TimeRange& range)
+    : source_(std::move(source)), range_(range) {}
+
+bool RangeCandleSource::next(std::vector<Candle>& batch) {
+  while (source_->next(batch)) {
+    batch.erase(std::remove_if(batch.begin(), batch.end(),
+                               [&](const Candle& c) { return !range_.contains(c.timestamp); }),
+                batch.end());
+    if (!batch.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+ResampledCandleSource::ResampledCandleSource(std::unique_ptr<CandleSource> source,
+                                             Timestamp period)
+    : source_(std::move(source)), aggregator_(period) {}
+
+bool ResampledCandleSource::next(std::vector<Candle>& batch) {
+  batch.clear();
+  Candle completed;
+  while (batch.empty() && !done_) {
+    if (!source_->next(input_)) {
+      done_ = true;
+      if (aggregator_.flush(completed)) {
+        batch.push_back(completed);
+      }
+      break;
+    }
+    for (const auto& candle : input_) {
+      if (aggregator_.add(candle, completed)) {
+        batch.push_back(completed);
+      }
+    }
+  }
+  return !batch.empty();
+}
+
+}  // namespace lwti
@@ -0,0 +1,378 @@
+#include "io/candle_store.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "core/temp_path.hpp"
+
+namespace lwti {
+namespace {
+
+constexpr char kMagic[8] = {'L', 'W', 'T', 'I', 'S', 'T', 'R', '\0'};
+constexpr std::uint32_t kVersion = 2;  // v1 had no block index
+constexpr std::uint32_t kEndianTag = 0x01020304;
+
+struct StoreHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t endian_tag;
+  std::uint64_t rows;
+  std::uint64_t blocks;
+  std::uint64_t index_offset;
+  std::uint64_t reserved;
+};
+static_assert(sizeof(StoreHeader) == 48);
+static_assert(sizeof(StoreBlockInfo) == 64);
+
+constexpr std::size_t kValueColumns = 5;  // open, high, low, close, volume
+constexpr std::uint8_t kRawScale = 0xFF;
+constexpr int kMaxScale = 9;
+
+struct BlockHeader {
+  std::uint32_t rows;
+  std::uint32_t bytes;  // payload size
+  Timestamp first_timestamp;
+  std::uint8_t scales[kValueColumns];
+  std::uint8_t reserved[3];
+};
+static_assert(sizeof(BlockHeader) == 24);
+
+constexpr double Candle::*kFields[kValueColumns] = {&Candle::open, &Candle::high, &Candle::low,
+                                                    &Candle::close, &Candle::volume};
+constexpr bool kDeltaCoded[kValueColumns] = {true, true, true, true, false};
+
+constexpr double kPow10[kMaxScale + 1] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+// Scaled values stay below 2^53, where doubles still hold every integer.
+constexpr double kMaxScaled = 9007199254740992.0;
+
+std::uint64_t zigzag(std::int64_t v) {
+  return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t v) {
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+void put_varint(std::string& out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<char>(v));
+}
+
+bool get_varint(const char*& p, const char* end, std::uint64_t& v) {
+  v = 0;
+  for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+    const auto byte = static_cast<std::uint8_t>(*p++);
+    v |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+// Smallest decimal scale at which every value round-trips through an
+// integer; kRawScale when none does.
+std::uint8_t pick_scale(const Candle* rows, std::size_t count, double Candle::*field) {
+  for (int e = 0; e <= kMaxScale; ++e) {
+    bool exact = true;
+    for (std::size_t i = 0; i < count && exact; ++i) {
+      const double v = rows[i].*field;
+      const double scaled = std::round(v * kPow10[e]);
+      exact = std::fabs(scaled) < kMaxScaled && scaled / kPow10[e] == v;
+    }
+    if (exact) return static_cast<std::uint8_t>(e);
+  }
+  return kRawScale;
+}
+
+StoreBlockInfo zone_map(const Candle* rows, std::size_t count, std::uint64_t offset) {
+  StoreBlockInfo info{offset,           count,          rows[0].timestamp, rows[0].timestamp,
+                      rows[0].close,    rows[0].close,  rows[0].volume,    rows[0].volume};
+  for (std::size_t i = 1; i < count; ++i) {
+    info.min_timestamp = std::min(info.min_timestamp, rows[i].timestamp);
+    info.max_timestamp = std::max(info.max_timestamp, rows[i].timestamp);
+    info.min_close = std::min(info.min_close, rows[i].close);
+    info.max_close = std::max(info.max_close, rows[i].close);
+    info.min_volume = std::min(info.min_volume, rows[i].volume);
+    info.max_volume = std::max(info.max_volume, rows[i].volume);
+  }
+  return info;
+}
+
+void encode_block(const Candle* rows, std::size_t count, BlockHeader& header,
+                  std::string& payload) {
+  header = BlockHeader{};
+  header.rows = static_cast<std::uint32_t>(count);
+  header.first_timestamp = rows[0].timestamp;
+  payload.clear();
+
+  Timestamp prev_delta = 0;
+  for (std::size_t i = 1; i < count; ++i) {
+    const Timestamp delta = rows[i].timestamp - rows[i - 1].timestamp;
+    put_varint(payload, zigzag(delta - prev_delta));
+    prev_delta = delta;
+  }
+
+  for (std::size_t c = 0; c < kValueColumns; ++c) {
+    double Candle::*field = kFields[c];
+    const std::uint8_t scale = pick_scale(rows, count, field);
+    header.scales[c] = scale;
+    if (scale == kRawScale) {
+      for (std::size_t i = 0; i < count; ++i) {
+        char bytes[sizeof(double)];
+        std::memcpy(bytes, &(rows[i].*field), sizeof(double));
+        payload.append(bytes, sizeof(bytes));
+      }
+      continue;
+    }
+    std::int64_t prev = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto q = static_cast<std::int64_t>(std::round(rows[i].*field * kPow10[scale]));
+      put_varint(payload, zigzag(kDeltaCoded[c] ? q - prev : q));
+      prev = q;
+    }
+  }
+  header.bytes = static_cast<std::uint32_t>(payload.size());
+}
+
+// Decodes one block of expected_rows rows at cursor into out and advances
+// cursor past it. Varints are unpacked into an integer scratch column
+// first, so the integer-to-double conversion runs as a flat loop.
+bool decode_block(const char*& cursor, const char* end, std::size_t expected_rows,
+                  std::vector<Candle>& out, std::vector<std::int64_t>& scratch) {
+  if (static_cast<std::size_t>(end - cursor) < sizeof(BlockHeader)) {
+    return false;
+  }
+  BlockHeader header;
+  std::memcpy(&header, cursor, sizeof(header));
+  cursor += sizeof(header);
+  // Every row after the first takes at least one timestamp byte, so a
+  // corrupt row count is rejected here rather than sized into out.
+  if (header.rows == 0 || header.rows != expected_rows ||
+      header.bytes > static_cast<std::size_t>(end - cursor) || header.rows - 1 > header.bytes) {
+    return false;
+  }
+  const char* p = cursor;
+  const char* const block_end = cursor + header.bytes;
+  const std::size_t rows = header.rows;
+  out.resize(rows);
+  scratch.resize(rows);
+
+  std::uint64_t raw = 0;
+  Timestamp ts = header.first_timestamp;
+  Timestamp delta = 0;
+  out[0].timestamp = ts;
+  for (std::size_t i = 1; i < rows; ++i) {
+    if (!get_varint(p, block_end, raw)) return false;
+    delta += unzigzag(raw);
+    ts += delta;
+    out[i].timestamp = ts;
+  }
+
+  for (std::size_t c = 0; c < kValueColumns; ++c) {
+    double Candle::*field = kFields[c];
+    const std::uint8_t scale = header.scales[c];
+    if (scale == kRawScale) {
+      if (static_cast<std::size_t>(block_end - p) < rows * sizeof(double)) return false;
+      for (std::size_t i = 0; i < rows; ++i, p += sizeof(double)) {
+        std::memcpy(&(out[i].*field), p, sizeof(double));
+      }
+      continue;
+    }
+    if (scale > kMaxScale) return false;
+    for (std::size_t i = 0; i < rows; ++i) {
+      if (!get_varint(p, block_end, raw)) return false;
+      scratch[i] = unzigzag(raw);
+    }
+    if (kDeltaCoded[c]) {
+      for (std::size_t i = 1; i < rows; ++i) scratch[i] += scratch[i - 1];
+    }
+    // Division (not multiplication by 10^-scale) reproduces the source
+    // doubles exactly.
+    const double divisor = kPow10[scale];
+    for (std::size_t i = 0; i < rows; ++i) {
+      out[i].*field = static_cast<double>(scratch[i]) / divisor;
+    }
+  }
+  if (p != block_end) return false;
+  cursor = block_end;
+  return true;
+}
+
+// Validates the header and loads the block index.
+bool read_index(const MappedFile& file, StoreHeader& header, std::vector<StoreBlockInfo>& index) {
+  if (!file.is_open() || file.size() < sizeof(StoreHeader)) {
+    return false;
+  }
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+      header.endian_tag != kEndianTag || header.index_offset < sizeof(StoreHeader) ||
+      header.index_offset > file.size() ||
+      (file.size() - header.index_offset) / sizeof(StoreBlockInfo) != header.blocks ||
+      (file.size() - header.index_offset) % sizeof(StoreBlockInfo) != 0) {
+    return false;
+  }
+  index.resize(header.blocks);
+  std::memcpy(index.data(), file.data() + header.index_offset,
+              header.blocks * sizeof(StoreBlockInfo));
+  // Blocks are laid out in index order, each spanning up to the next one.
+  // A block of n rows needs its header plus at least n - 1 timestamp bytes,
+  // and n is capped at kStoreBlockRows, so the row sum cannot wrap.
+  std::uint64_t rows = 0;
+  std::uint64_t previous = 0;
+  for (std::size_t b = 0; b < index.size(); ++b) {
+    const StoreBlockInfo& info = index[b];
+    const std::uint64_t next = b + 1 < index.size() ? index[b + 1].offset : header.index_offset;
+    if (info.offset < sizeof(StoreHeader) || info.offset <= previous || next <= info.offset ||
+        next > header.index_offset || info.rows == 0 || info.rows > kStoreBlockRows ||
+        next - info.offset < sizeof(BlockHeader) ||
+        info.rows - 1 > next - info.offset - sizeof(BlockHeader)) {
+      return false;
+    }
+    previous = info.offset;
+    rows += info.rows;
+  }
+  return rows == header.rows;
+}
+
+// Decodes the indexed block into out, keeping only rows in range. Blocks
+// end where the index starts.
+bool decode_indexed(const MappedFile& file, std::uint64_t index_offset,
+                    const StoreBlockInfo& info, const TimeRange& range, std::vector<Candle>& out,
+                    std::vector<std::int64_t>& scratch) {
+  const char* cursor = file.data() + info.offset;
+  if (!decode_block(cursor, file.data() + index_offset, info.rows, out, scratch)) {
+    return false;
+  }
+  if (range.from > info.min_timestamp || range.to <= info.max_timestamp) {
+    out.erase(std::remove_if(out.begin(), out.end(),
+                             [&](const Candle& c) { return !range.contains(c.timestamp); }),
+              out.end());
+  }
+  return true;
+}
+
+}  // namespace
+
+bool is_candle_store(const std::string& path) {
+  const std::size_t n = std::strlen(kStoreExtension);
+  return path.size() > n && path.compare(path.size() - n, n, kStoreExtension) == 0;
+}
+
+bool write_candle_store(const std::string& path, const std::vector<Candle>& candles,
+                        std::size_t block_rows) {
+  block_rows = std::clamp<std::size_t>(block_rows, 1, kStoreBlockRows);
+  StoreHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endian_tag = kEndianTag;
+  header.rows = candles.size();
+  header.blocks = (candles.size() + block_rows - 1) / block_rows;
+
+  const std::string tmp_path = temp_path_for(path);
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::vector<StoreBlockInfo> index;
+    index.reserve(header.blocks);
+    std::uint64_t offset = sizeof(header);
+    BlockHeader block;
+    std::string payload;
+    for (std::size_t start = 0; start < candles.size(); start += block_rows) {
+      const std::size_t count = std::min(block_rows, candles.size() - start);
+      encode_block(candles.data() + start, count, block, payload);
+      index.push_back(zone_map(candles.data() + start, count, offset));
+      out.write(reinterpret_cast<const char*>(&block), sizeof(block));
+      out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+      offset += sizeof(block) + payload.size();
+    }
+    out.write(reinterpret_cast<const char*>(index.data()),
+              static_cast<std::streamsize>(index.size() * sizeof(StoreBlockInfo)));
+    header.index_offset = offset;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out) {
+      out.close();
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::optional<std::vector<Candle>> read_candle_store(const std::string& path,
+                                                     const TimeRange& range) {
+  const MappedFile file(path);
+  StoreHeader header{};
+  std::vector<StoreBlockInfo> index;
+  if (!read_index(file, header, index)) {
+    return std::nullopt;
+  }
+  std::size_t rows = 0;
+  for (const auto& info : index) {
+    if (range.overlaps(info.min_timestamp, info.max_timestamp)) rows += info.rows;
+  }
+  std::vector<Candle> candles;
+  candles.reserve(rows);
+  std::vector<Candle> block;
+  std::vector<std::int64_t> scratch;
+  for (const auto& info : index) {
+    if (!range.overlaps(info.min_timestamp, info.max_timestamp)) {
+      continue;
+    }
+    if (!decode_indexed(file, header.index_offset, info, range, block, scratch)) {
+      return std::nullopt;
+    }
+    candles.insert(candles.end(), block.begin(), block.end());
+  }
+  return candles;
+}
+
+std::optional<std::vector<StoreBlockInfo>> read_store_index(const std::string& path) {
+  const MappedFile file(path);
+  StoreHeader header{};
+  std::vector<StoreBlockInfo> index;
+  if (!read_index(file, header, index)) {
+    return std::nullopt;
+  }
+  return index;
+}
+
+StoreCandleSource::StoreCandleSource(const std::string& path, const TimeRange& range)
+    : file_(path), range_(range) {
+  StoreHeader header{};
+  valid_ = read_index(file_, header, index_);
+  index_offset_ = header.index_offset;
+}
+
+bool StoreCandleSource::next(std::vector<Candle>& batch) {
+  batch.clear();
+  while (valid_ && batch.empty() && next_block_ < index_.size()) {
+    const StoreBlockInfo& info = index_[next_block_++];
+    if (!range_.overlaps(info.min_timestamp, info.max_timestamp)) {
+      continue;
+    }
+    if (!decode_indexed(file_, index_offset_, info, range_, batch, scratch_)) {
+      batch.clear();
+      valid_ = false;
+      break;
+    }
+    file_.release(released_, info.offset - released_);
+    released_ = info.offset;
+  }
+  return !batch.empty();
+}
+
+}  // namespace lwti
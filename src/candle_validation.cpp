@@ -0,0 +1,127 @@
+#include "io/candle_validation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "io/parallel.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LWTI_VALIDATION_X86 1
+#endif
+
+namespace lwti {
+namespace {
+
+// Comparisons are summed instead of branched on so the loop vectorizes;
+// it is inlined into each target build below.
+[[gnu::always_inline]] inline ValidationReport check_rows(const Candle* c, std::size_t n) {
+  ValidationReport r;
+  r.rows = n;
+  for (std::size_t i = 0; i < n; ++i) {
+    const Candle& x = c[i];
+    r.bad_high += x.high < std::max(x.open, x.close);
+    r.bad_low += x.low > std::min(x.open, x.close);
+    r.negative_volume += x.volume < 0.0;
+    r.zero_price += (x.open <= 0.0) | (x.high <= 0.0) | (x.low <= 0.0) | (x.close <= 0.0);
+    r.non_finite += !std::isfinite(x.open) | !std::isfinite(x.high) | !std::isfinite(x.low) |
+                    !std::isfinite(x.close) | !std::isfinite(x.volume);
+  }
+  for (std::size_t i = 1; i < n; ++i) {
+    r.out_of_order += c[i].timestamp < c[i - 1].timestamp;
+    r.duplicates += c[i].timestamp == c[i - 1].timestamp;
+  }
+  return r;
+}
+
+using RowChecker = ValidationReport (*)(const Candle*, std::size_t);
+
+[[maybe_unused]] ValidationReport check_scalar(const Candle* c, std::size_t n) {
+  return check_rows(c, n);
+}
+
+#ifdef LWTI_VALIDATION_X86
+__attribute__((target("avx2"))) ValidationReport check_avx2(const Candle* c, std::size_t n) {
+  return check_rows(c, n);
+}
+#endif
+
+RowChecker select_checker() {
+#ifdef LWTI_VALIDATION_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return check_avx2;
+  }
+#endif
+  return check_scalar;
+}
+
+bool earlier(const Candle& a, const Candle& b) { return a.timestamp < b.timestamp; }
+
+bool same_time(const Candle& a, const Candle& b) { return a.timestamp == b.timestamp; }
+
+std::size_t resolve_threads(std::size_t requested, std::size_t rows) {
+  // Below this a slice sorts faster than a thread is spawned.
+  constexpr std::size_t kMinSliceRows = 1 << 16;
+  return resolve_workers(requested, rows, kMinSliceRows);
+}
+
+// Sorts slices on their own threads, then merges neighbouring slices in
+// parallel rounds until one is left. Stable throughout, so equal
+// timestamps keep their input order.
+void parallel_stable_sort(std::vector<Candle>& candles, std::size_t threads) {
+  const std::size_t workers = resolve_threads(threads, candles.size());
+  std::vector<std::size_t> bounds(workers + 1);
+  for (std::size_t w = 0; w <= workers; ++w) {
+    bounds[w] = candles.size() * w / workers;
+  }
+  const auto at = [&](std::size_t offset) { return candles.begin() + static_cast<long>(offset); };
+
+  std::vector<std::thread> pool;
+  for (std::size_t w = 0; w < workers; ++w) {
+    pool.emplace_back([&, w] { std::stable_sort(at(bounds[w]), at(bounds[w + 1]), earlier); });
+  }
+  for (auto& worker : pool) worker.join();
+
+  while (bounds.size() > 2) {
+    pool.clear();
+    std::vector<std::size_t> merged{0};
+    for (std::size_t s = 0; s + 2 < bounds.size(); s += 2) {
+      const std::size_t first = bounds[s], middle = bounds[s + 1], last = bounds[s + 2];
+      pool.emplace_back([&, first, middle, last] {
+        std::inplace_merge(at(first), at(middle), at(last), earlier);
+      });
+      merged.push_back(last);
+    }
+    if (merged.back() != bounds.back()) merged.push_back(bounds.back());
+    for (auto& worker : pool) worker.join();
+    bounds = std::move(merged);
+  }
+}
+
+}  // namespace
+
+ValidationReport check_candles(const std::vector<Candle>& candles) {
+  static const RowChecker checker = select_checker();
+  return checker(candles.data(), candles.size());
+}
+
+std::size_t repair_candles(std::vector<Candle>& candles, std::size_t threads) {
+  if (!std::is_sorted(candles.begin(), candles.end(), earlier)) {
+    parallel_stable_sort(candles, threads);
+  }
+  const auto last = std::unique(candles.begin(), candles.end(), same_time);
+  const auto dropped = static_cast<std::size_t>(candles.end() - last);
+  candles.erase(last, candles.end());
+  return dropped;
+}
+
+ValidationReport validate_candles(std::vector<Candle>& candles, std::size_t threads) {
+  ValidationReport report = check_candles(candles);
+  if (report.out_of_order > 0 || report.duplicates > 0) {
+    report.duplicates = repair_candles(candles, threads);
+  }
+  return report;
+}
+
+}  // namespace lwti
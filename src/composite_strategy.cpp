@@ -2,55 +2,142 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <utility>
 
 namespace lwti {
+namespace {
 
-CompositeStrategy::CompositeStrategy(CompositeStrategyConfig config) : config_(config) {
+// Calls emit(bar, code) with the score-table index of every bar.
+template <typename Emit>
+void for_each_code(const SignalColumn& lwti, const SignalColumn& vwap, const SignalColumn& regime,
+                   Emit&& emit) {
+  const std::size_t n = std::min({lwti.size(), vwap.size(), regime.size()});
+  for (std::size_t w = 0; w * SignalColumn::kBarsPerWord < n; ++w) {
+    const std::uint64_t l = lwti.words()[w];
+    const std::uint64_t v = vwap.words()[w];
+    const std::uint64_t r = regime.words()[w];
+    const std::size_t first = w * SignalColumn::kBarsPerWord;
+    const std::size_t bars = std::min(SignalColumn::kBarsPerWord, n - first);
+    for (std::size_t j = 0; j < bars; ++j) {
+      const unsigned shift = static_cast<unsigned>(2 * j);
+      emit(first + j, ((l >> shift) & 3) | ((v >> shift) & 3) << 2 | ((r >> shift) & 3) << 4);
+    }
+  }
+}
+
+}  // namespace
+
+template <typename Scalar>
+BasicCompositeStrategy<Scalar>::BasicCompositeStrategy(CompositeStrategyConfig config)
+    : config_(config) {
   config_.max_position = std::clamp(config_.max_position, 0.0, 5.0);
   config_.lwti_weight = std::max(0.0, config_.lwti_weight);
   config_.vwap_weight = std::max(0.0, config_.vwap_weight);
 }
 
-std::vector<StrategyPoint> CompositeStrategy::generate(
-    const std::vector<IndicatorPoint>& lwti_points,
-    const std::vector<VwapBandPoint>& vwap_points,
-    const std::vector<RegimePoint>& regimes) const {
-  const std::size_t n =
-      std::min({lwti_points.size(), vwap_points.size(), regimes.size()});
-  std::vector<StrategyPoint> out;
-  out.reserve(n);
+template <typename Scalar>
+auto BasicCompositeStrategy<Scalar>::generate(
+    const std::vector<BasicIndicatorPoint<Scalar>>& lwti_points,
+    const std::vector<BasicVwapBandPoint<Scalar>>& vwap_points,
+    const std::vector<BasicRegimePoint<Scalar>>& regimes) const -> std::vector<Point> {
+  std::vector<Point> out(std::min({lwti_points.size(), vwap_points.size(), regimes.size()}));
+  generate(std::span(lwti_points), std::span(vwap_points), std::span(regimes), std::span(out));
+  return out;
+}
 
+template <typename Scalar>
+std::size_t BasicCompositeStrategy<Scalar>::generate(
+    std::span<const BasicIndicatorPoint<Scalar>> lwti_points,
+    std::span<const BasicVwapBandPoint<Scalar>> vwap_points,
+    std::span<const BasicRegimePoint<Scalar>> regimes, std::span<Point> out) const {
+  const std::size_t n =
+      std::min({lwti_points.size(), vwap_points.size(), regimes.size(), out.size()});
   for (std::size_t i = 0; i < n; ++i) {
-    const auto& l = lwti_points[i];
-    const auto& v = vwap_points[i];
-    const auto& r = regimes[i];
+    out[i] = evaluate(lwti_points[i], vwap_points[i], regimes[i]);
+  }
+  return n;
+}
 
-    double score = 0.0;
-    score += config_.lwti_weight * static_cast<double>(signal_polarity(l.signal));
-    score += config_.vwap_weight * static_cast<double>(signal_polarity(v.signal));
+template <typename Scalar>
+auto BasicCompositeStrategy<Scalar>::score_table() const -> std::vector<Point> {
+  std::vector<Point> table(64);
+  for (std::uint64_t code = 0; code < table.size(); ++code) {
+    BasicIndicatorPoint<Scalar> l;
+    BasicVwapBandPoint<Scalar> v;
+    BasicRegimePoint<Scalar> r;
+    l.signal = signal_from_code(code & 3);
+    v.signal = signal_from_code((code >> 2) & 3);
+    r.regime = signal_from_code(code >> 4) == Signal::Flat ? VolatilityRegime::High
+                                                           : VolatilityRegime::Low;
+    table[code] = evaluate(l, v, r);
+  }
+  return table;
+}
 
-    if (r.regime == VolatilityRegime::High) {
-      score = 0.0;  // risk-off during high volatility
-    }
+template <typename Scalar>
+auto BasicCompositeStrategy<Scalar>::generate(const SignalColumn& lwti_signals,
+                                              const SignalColumn& vwap_signals,
+                                              const SignalColumn& regime_signals) const
+    -> std::vector<Point> {
+  const std::vector<Point> table = score_table();
+  std::vector<Point> out(
+      std::min({lwti_signals.size(), vwap_signals.size(), regime_signals.size()}));
+  for_each_code(lwti_signals, vwap_signals, regime_signals,
+                [&](std::size_t bar, std::uint64_t code) { out[bar] = table[code]; });
+  return out;
+}
 
-    Signal signal = Signal::Flat;
-    if (score > 1e-6) {
-      signal = Signal::Long;
-    } else if (score < -1e-6) {
-      signal = Signal::Short;
-    }
+template <typename Scalar>
+SignalColumn BasicCompositeStrategy<Scalar>::signals(const SignalColumn& lwti_signals,
+                                                     const SignalColumn& vwap_signals,
+                                                     const SignalColumn& regime_signals) const {
+  const std::vector<Point> table = score_table();
+  std::uint64_t codes[64];
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    codes[i] = signal_code(table[i].signal);
+  }
+  constexpr std::size_t kBars = SignalColumn::kBarsPerWord;
+  const std::size_t n =
+      std::min({lwti_signals.size(), vwap_signals.size(), regime_signals.size()});
+  std::vector<std::uint64_t> words((n + kBars - 1) / kBars);
+  for_each_code(lwti_signals, vwap_signals, regime_signals,
+                [&](std::size_t bar, std::uint64_t code) {
+                  words[bar / kBars] |= codes[code] << (2 * (bar % kBars));
+                });
+  return SignalColumn::from_words(std::move(words), n);
+}
 
-    double position = 0.0;
-    if (signal == Signal::Long) {
-      position = config_.max_position;
-    } else if (signal == Signal::Short) {
-      position = -config_.max_position;
-    }
+template <typename Scalar>
+auto BasicCompositeStrategy<Scalar>::evaluate(const BasicIndicatorPoint<Scalar>& l,
+                                              const BasicVwapBandPoint<Scalar>& v,
+                                              const BasicRegimePoint<Scalar>& r) const -> Point {
+  double score = 0.0;
+  score += config_.lwti_weight * static_cast<double>(signal_polarity(l.signal));
+  score += config_.vwap_weight * static_cast<double>(signal_polarity(v.signal));
 
-    out.push_back({i, l.timestamp, score, position, signal});
+  if (r.regime == VolatilityRegime::High) {
+    score = 0.0;  // risk-off during high volatility
   }
 
-  return out;
+  Signal signal = Signal::Flat;
+  if (score > 1e-6) {
+    signal = Signal::Long;
+  } else if (score < -1e-6) {
+    signal = Signal::Short;
+  }
+
+  double position = 0.0;
+  if (signal == Signal::Long) {
+    position = config_.max_position;
+  } else if (signal == Signal::Short) {
+    position = -config_.max_position;
+  }
+
+  return {static_cast<Scalar>(score), static_cast<Scalar>(position), signal};
 }
 
+template class BasicCompositeStrategy<float>;
+template class BasicCompositeStrategy<double>;
+
 }  // namespace lwti
@@ -0,0 +1,186 @@
+#include "io/csv_index.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "core/temp_path.hpp"
+#include "csv_reader.hpp"
+#include "io/field_parse.hpp"
+#include "io/mapped_file.hpp"
+
+namespace lwti {
+namespace {
+
+constexpr char kMagic[8] = {'L', 'W', 'T', 'I', 'I', 'D', 'X', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kEndianTag = 0x01020304;
+constexpr std::uint64_t kSortedFlag = 1;
+
+struct IndexHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t endian_tag;
+  std::uint64_t source_size;
+  std::int64_t source_mtime_ns;
+  std::uint64_t source_hash;
+  std::uint64_t stride;
+  std::uint64_t count;
+  std::uint64_t flags;
+};
+static_assert(sizeof(IndexHeader) == 64);
+static_assert(sizeof(CsvIndexEntry) == 16);
+
+}  // namespace
+
+std::pair<std::uint64_t, std::uint64_t> CsvIndex::window(const TimeRange& range,
+                                                         std::uint64_t file_size) const {
+  if (!sorted || entries.empty() || !range.bounded()) {
+    return {0, file_size};
+  }
+  const auto before = [](const CsvIndexEntry& e, Timestamp ts) { return e.timestamp < ts; };
+  // Rows ahead of the last entry below from are all below it too.
+  const auto lo = std::lower_bound(entries.begin(), entries.end(), range.from, before);
+  const auto hi = std::lower_bound(lo, entries.end(), range.to, before);
+  const std::uint64_t first = lo == entries.begin() ? 0 : std::prev(lo)->offset;
+  const std::uint64_t last = hi == entries.end() ? file_size : hi->offset;
+  return {first, std::max(first, last)};
+}
+
+std::vector<std::uint64_t> CsvIndex::splits(std::uint64_t first, std::uint64_t last,
+                                            std::size_t parts) const {
+  std::vector<std::uint64_t> bounds{first};
+  const auto below = [](const CsvIndexEntry& e, std::uint64_t offset) { return e.offset < offset; };
+  for (std::size_t p = 1; p < parts; ++p) {
+    const std::uint64_t target = first + (last - first) * p / parts;
+    const auto it = std::lower_bound(entries.begin(), entries.end(), target, below);
+    if (it != entries.end() && it->offset > bounds.back() && it->offset < last) {
+      bounds.push_back(it->offset);
+    }
+  }
+  bounds.push_back(last);
+  return bounds;
+}
+
+std::string csv_index_path(const std::string& csv_path) { return csv_path + ".lwtx"; }
+
+CsvIndex build_csv_index(const char* data, std::size_t size, std::uint64_t stride) {
+  CsvIndex index;
+  index.stride = std::max<std::uint64_t>(1, stride);
+  index.sorted = true;
+
+  ColumnPlan plan;
+  bool resolved = false;
+  const char* const end = data + size;
+  const char* const body = read_candle_header(data, end, plan, resolved);
+  // Only the timestamp column is routed; the rest are skipped unread.
+  ColumnSlots slots;
+  slots.fill(kSkipColumn);
+  slots[plan.columns[ColumnPlan::kTimestamp]] = 0;
+
+  std::uint64_t rows = 0;
+  Timestamp previous = 0;
+  for_each_row<1>(body, end, slots,
+                  [&](std::string_view line, const auto& fields, std::size_t count) {
+                    Timestamp ts = 0;
+                    if (line.empty() || count < plan.min_fields ||
+                        !parse_timestamp(trim(fields[0]), ts)) {
+                      return;
+                    }
+                    if (rows > 0 && ts < previous) index.sorted = false;
+                    if (rows % index.stride == 0) {
+                      index.entries.push_back({static_cast<std::uint64_t>(line.data() - data), ts});
+                    }
+                    previous = ts;
+                    ++rows;
+                  });
+  return index;
+}
+
+std::optional<CsvIndex> read_csv_index(const std::string& index_path,
+                                       const SourceFingerprint& source) {
+  const MappedFile file(index_path);
+  if (!file.is_open() || file.size() < sizeof(IndexHeader)) {
+    return std::nullopt;
+  }
+  IndexHeader header{};
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+      header.endian_tag != kEndianTag || header.stride == 0) {
+    return std::nullopt;
+  }
+  if (header.source_size != source.size || header.source_mtime_ns != source.mtime_ns ||
+      header.source_hash != source.hash) {
+    return std::nullopt;
+  }
+  // Bounded by division first so a crafted count cannot wrap the product.
+  const std::size_t body = file.size() - sizeof(IndexHeader);
+  if (header.count > body / sizeof(CsvIndexEntry) ||
+      body != header.count * sizeof(CsvIndexEntry)) {
+    return std::nullopt;
+  }
+  CsvIndex index;
+  index.stride = header.stride;
+  index.sorted = (header.flags & kSortedFlag) != 0;
+  index.entries.resize(header.count);
+  std::memcpy(index.entries.data(), file.data() + sizeof(IndexHeader),
+              header.count * sizeof(CsvIndexEntry));
+  return index;
+}
+
+bool write_csv_index(const std::string& index_path, const SourceFingerprint& source,
+                     const CsvIndex& index) {
+  IndexHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endian_tag = kEndianTag;
+  header.source_size = source.size;
+  header.source_mtime_ns = source.mtime_ns;
+  header.source_hash = source.hash;
+  header.stride = index.stride;
+  header.count = index.entries.size();
+  header.flags = index.sorted ? kSortedFlag : 0;
+
+  const std::string tmp_path = temp_path_for(index_path);
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(index.entries.data()),
+              static_cast<std::streamsize>(index.entries.size() * sizeof(CsvIndexEntry)));
+    if (!out) {
+      out.close();
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), index_path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::optional<CsvIndex> load_csv_index(const std::string& csv_path) {
+  const auto source = sampled_fingerprint(csv_path);
+  if (!source) {
+    return std::nullopt;
+  }
+  const std::string index_path = csv_index_path(csv_path);
+  if (auto index = read_csv_index(index_path, *source)) {
+    return index;
+  }
+  const MappedFile file(csv_path);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  CsvIndex index = build_csv_index(file.data(), file.size());
+  write_csv_index(index_path, *source, index);
+  return index;
+}
+
+}  // namespace lwti
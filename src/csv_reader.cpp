@@ -1,78 +1,417 @@
 #include "csv_reader.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
-#include <fstream>
-#include <sstream>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "core/time.hpp"
+#include "io/field_parse.hpp"
+#include "io/mapped_file.hpp"
+#include "io/parallel.hpp"
 
 namespace lwti {
 namespace {
 
-bool parse_double(const std::string& text, double& out) {
-  try {
-    size_t idx = 0;
-    out = std::stod(text, &idx);
-    return idx == text.size();
-  } catch (...) {
-    return false;
+constexpr std::size_t kColumns = 6;
+
+// Splits a line into its first kColumns trimmed fields without copying;
+// only used to inspect the header candidate.
+// Returns the total number of fields on the line.
+std::size_t split_fields(std::string_view line, std::array<std::string_view, kColumns>& fields) {
+  std::size_t count = 0;
+  std::size_t start = 0;
+  while (true) {
+    const std::size_t comma = line.find(',', start);
+    const std::size_t stop = comma == std::string_view::npos ? line.size() : comma;
+    if (count < kColumns) {
+      fields[count] = trim(line.substr(start, stop - start));
+    }
+    ++count;
+    if (comma == std::string_view::npos) break;
+    start = comma + 1;
   }
+  return count;
 }
 
-std::vector<std::string> split(const std::string& line, char delim) {
-  std::vector<std::string> tokens;
-  std::stringstream ss(line);
-  std::string item;
-  while (std::getline(ss, item, delim)) {
-    tokens.push_back(item);
+// Rough row count from the average length of the leading lines, so the
+// output vector is sized once instead of growing through reallocations.
+std::size_t estimate_rows(std::string_view data) {
+  constexpr std::size_t kSampleLines = 64;
+  std::size_t lines = 0;
+  std::size_t pos = 0;
+  while (lines < kSampleLines && pos < data.size()) {
+    const std::size_t nl = data.find('\n', pos);
+    if (nl == std::string_view::npos) break;
+    pos = nl + 1;
+    ++lines;
   }
-  return tokens;
+  if (lines == 0 || pos == 0) return 1;
+  return data.size() / (pos / lines) + 1;
 }
 
-void trim(std::string& s) {
-  auto not_space = [](unsigned char ch) { return !std::isspace(ch); };
-  s.erase(s.begin(), std::find_if(s.begin(), s.end(), not_space));
-  s.erase(std::find_if(s.rbegin(), s.rend(), not_space).base(), s.end());
+// Moves a chunk boundary forward to the start of the next line.
+const char* align_to_line(const char* pos, const char* begin, const char* end) {
+  if (pos <= begin) return begin;
+  if (pos >= end) return end;
+  if (pos[-1] == '\n') return pos;
+  const void* nl = std::memchr(pos, '\n', static_cast<std::size_t>(end - pos));
+  return nl != nullptr ? static_cast<const char*>(nl) + 1 : end;
 }
 
-}  // namespace
+std::size_t resolve_threads(std::size_t requested, std::size_t bytes) {
+  // Below this a chunk is parsed faster than a thread is spawned.
+  constexpr std::size_t kMinChunkBytes = 1 << 20;
+  return resolve_workers(requested, bytes, kMinChunkBytes);
+}
 
-std::vector<Candle> read_candles_csv(const std::string& path) {
-  std::ifstream input(path);
-  std::vector<Candle> candles;
-  if (!input.is_open()) {
-    return candles;
-  }
+// Per-symbol buffers of one chunk. Names point into the mapped file.
+struct SymbolChunk {
+  std::unordered_map<std::string_view, std::size_t> index;
+  std::vector<std::string_view> names;
+  std::vector<std::vector<Candle>> series;
+};
 
-  std::string line;
-  bool first_line = true;
-  while (std::getline(input, line)) {
-    if (line.empty()) {
-      continue;
+std::optional<std::size_t> symbol_column(std::string_view header) {
+  std::size_t column = 0;
+  std::string name;
+  while (true) {
+    const std::size_t comma = header.find(',');
+    name.assign(trim(header.substr(0, comma)));
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    if (name == "symbol" || name == "ticker" || name == "sym" || name == "instrument") {
+      return column;
     }
-    auto tokens = split(line, ',');
-    if (tokens.size() < 6) {
-      continue;
-    }
-    for (auto& token : tokens) {
-      trim(token);
+    if (comma == std::string_view::npos) return std::nullopt;
+    header.remove_prefix(comma + 1);
+    ++column;
+  }
+}
+
+}  // namespace
+
+std::optional<ColumnPlan> ColumnPlan::from_columns(
+    const std::array<std::size_t, kFieldCount>& columns) {
+  ColumnPlan plan;
+  plan.columns = columns;
+  plan.min_fields = 0;
+  plan.slots.fill(kSkipColumn);
+  for (std::size_t f = 0; f < kFieldCount; ++f) {
+    if (columns[f] >= kMaxMappedColumns || plan.slots[columns[f]] != kSkipColumn) {
+      return std::nullopt;
     }
-    if (first_line) {
-      first_line = false;
-      // Skip header if present.
-      if (!tokens.empty() && tokens[1] == "open") {
-        continue;
+    plan.slots[columns[f]] = static_cast<std::uint8_t>(f);
+    plan.min_fields = std::max(plan.min_fields, columns[f] + 1);
+  }
+  return plan;
+}
+
+std::optional<ColumnPlan> plan_from_header(std::string_view header) {
+  struct Alias {
+    std::string_view name;
+    ColumnPlan::Field field;
+  };
+  using F = ColumnPlan::Field;
+  static constexpr Alias kAliases[] = {
+      {"timestamp", F::kTimestamp}, {"time", F::kTimestamp}, {"datetime", F::kTimestamp},
+      {"date", F::kTimestamp},      {"ts", F::kTimestamp},   {"open", F::kOpen},
+      {"o", F::kOpen},              {"high", F::kHigh},      {"h", F::kHigh},
+      {"low", F::kLow},             {"l", F::kLow},          {"close", F::kClose},
+      {"c", F::kClose},             {"volume", F::kVolume},  {"vol", F::kVolume},
+      {"v", F::kVolume}};
+  constexpr std::size_t kMissing = static_cast<std::size_t>(-1);
+  std::array<std::size_t, ColumnPlan::kFieldCount> columns;
+  columns.fill(kMissing);
+
+  std::size_t column = 0;
+  std::string name;
+  while (true) {
+    const std::size_t comma = header.find(',');
+    const std::string_view token = trim(header.substr(0, comma));
+    name.assign(token);
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    for (const Alias& alias : kAliases) {
+      if (alias.name == name) {
+        if (columns[alias.field] == kMissing) columns[alias.field] = column;
+        break;
       }
     }
-    double open = 0.0, high = 0.0, low = 0.0, close = 0.0, volume = 0.0;
-    if (!parse_double(tokens[1], open) || !parse_double(tokens[2], high) ||
-        !parse_double(tokens[3], low) || !parse_double(tokens[4], close) ||
-        !parse_double(tokens[5], volume)) {
-      continue;
+    if (comma == std::string_view::npos) break;
+    header.remove_prefix(comma + 1);
+    ++column;
+  }
+  if (std::find(columns.begin(), columns.end(), kMissing) != columns.end()) {
+    return std::nullopt;
+  }
+  return ColumnPlan::from_columns(columns);
+}
+
+const char* read_candle_header(const char* begin, const char* end, ColumnPlan& plan,
+                               bool& resolved) {
+  std::array<std::string_view, kColumns> fields;
+  const char* cursor = begin;
+  while (cursor < end) {
+    const void* nl = std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor));
+    const char* line_end = nl != nullptr ? static_cast<const char*>(nl) : end;
+    const std::string_view line(cursor, static_cast<std::size_t>(line_end - cursor));
+    const char* next = line_end == end ? end : line_end + 1;
+    if (!line.empty() && split_fields(line, fields) >= kColumns) {
+      resolved = true;
+      if (auto compiled = plan_from_header(line)) {
+        plan = *compiled;
+        return next;
+      }
+      plan = ColumnPlan{};
+      // Skip a legacy header whose names are not all recognized.
+      return fields[1] == "open" ? next : begin;
     }
-    candles.push_back({tokens[0], open, high, low, close, volume});
+    cursor = next;
+  }
+  resolved = false;
+  return begin;
+}
+
+bool parse_candle_fields(const std::string_view* fields, Candle& candle) {
+  using F = ColumnPlan::Field;
+  return parse_timestamp(trim(fields[F::kTimestamp]), candle.timestamp) &&
+         parse_double(trim(fields[F::kOpen]), candle.open) &&
+         parse_double(trim(fields[F::kHigh]), candle.high) &&
+         parse_double(trim(fields[F::kLow]), candle.low) &&
+         parse_double(trim(fields[F::kClose]), candle.close) &&
+         parse_double(trim(fields[F::kVolume]), candle.volume);
+}
+
+void parse_candle_rows(const char* begin, const char* end, const ColumnPlan& plan,
+                       std::vector<Candle>& candles) {
+  for_each_row<ColumnPlan::kFieldCount>(
+      begin, end, plan.slots,
+      [&](std::string_view line, const auto& fields, std::size_t field_count) {
+        if (line.empty() || field_count < plan.min_fields) {
+          return;
+        }
+        Candle candle;
+        if (parse_candle_fields(fields.data(), candle)) {
+          candles.push_back(candle);
+        }
+      });
+}
+
+namespace {
+
+// Parses the chunks between consecutive bounds, one worker each. Chunks
+// start on line boundaries, so each row is parsed by exactly one worker
+// and stitching the chunks in order reproduces the serial output.
+std::vector<Candle> parse_chunks(const std::vector<const char*>& bounds, const ColumnPlan& plan) {
+  std::vector<Candle> candles;
+  const std::size_t workers = bounds.size() - 1;
+  if (workers == 1) {
+    candles.reserve(estimate_rows({bounds[0], static_cast<std::size_t>(bounds[1] - bounds[0])}));
+    parse_candle_rows(bounds[0], bounds[1], plan, candles);
+    return candles;
+  }
+
+  std::vector<std::vector<Candle>> chunks(workers);
+  std::vector<std::thread> pool;
+  pool.reserve(workers);
+  for (std::size_t w = 0; w < workers; ++w) {
+    pool.emplace_back([&, w] {
+      const std::size_t bytes = static_cast<std::size_t>(bounds[w + 1] - bounds[w]);
+      chunks[w].reserve(estimate_rows({bounds[w], bytes}));
+      parse_candle_rows(bounds[w], bounds[w + 1], plan, chunks[w]);
+    });
+  }
+  for (auto& worker : pool) {
+    worker.join();
+  }
+
+  std::size_t total = 0;
+  for (const auto& chunk : chunks) total += chunk.size();
+  candles.reserve(total);
+  for (auto& chunk : chunks) {
+    std::move(chunk.begin(), chunk.end(), std::back_inserter(candles));
+  }
+  return candles;
+}
+
+}  // namespace
+
+std::vector<Candle> read_candles_csv(const std::string& path, std::size_t threads) {
+  const MappedFile file(path);
+  if (!file.is_open()) {
+    return {};
+  }
+  const char* const end = file.data() + file.size();
+  ColumnPlan plan;
+  bool resolved = false;
+  const char* const body = read_candle_header(file.data(), end, plan, resolved);
+  const std::size_t body_size = static_cast<std::size_t>(end - body);
+  const std::size_t workers = resolve_threads(threads, body_size);
+
+  std::vector<const char*> bounds(workers + 1);
+  for (std::size_t w = 0; w <= workers; ++w) {
+    bounds[w] = align_to_line(body + body_size * w / workers, body, end);
+  }
+  return parse_chunks(bounds, plan);
+}
+
+std::vector<Candle> read_candles_csv(const std::string& path, std::size_t threads,
+                                     const CsvIndex& index, const TimeRange& range) {
+  const MappedFile file(path);
+  if (!file.is_open()) {
+    return {};
+  }
+  const char* const data = file.data();
+  ColumnPlan plan;
+  bool resolved = false;
+  const char* const body = read_candle_header(data, data + file.size(), plan, resolved);
+  const auto [from, to] = index.window(range, file.size());
+  const std::uint64_t first = std::max<std::uint64_t>(from, body - data);
+  const std::uint64_t last = std::min<std::uint64_t>(to, file.size());
+  if (first >= last) {
+    return {};
   }
 
+  std::vector<const char*> bounds;
+  for (const std::uint64_t offset :
+       index.splits(first, last, resolve_threads(threads, last - first))) {
+    bounds.push_back(data + offset);
+  }
+  auto candles = parse_chunks(bounds, plan);
+  if (range.bounded()) {
+    candles.erase(std::remove_if(candles.begin(), candles.end(),
+                                 [&](const Candle& c) { return !range.contains(c.timestamp); }),
+                  candles.end());
+  }
   return candles;
 }
 
+namespace {
+
+constexpr std::size_t kSymbolSlot = ColumnPlan::kFieldCount;
+
+void parse_symbol_rows(const char* begin, const char* end, const ColumnSlots& slots,
+                       std::size_t min_fields, SymbolChunk& chunk) {
+  // Long-format rows usually come in runs of one symbol; the last lookup
+  // is reused until the name changes.
+  std::string_view last_name;
+  std::size_t last = 0;
+  bool have_last = false;
+  for_each_row<ColumnPlan::kFieldCount + 1>(
+      begin, end, slots, [&](std::string_view line, const auto& fields, std::size_t count) {
+        if (line.empty() || count < min_fields) {
+          return;
+        }
+        Candle candle;
+        const std::string_view name = trim(fields[kSymbolSlot]);
+        if (name.empty() || !parse_candle_fields(fields.data(), candle)) {
+          return;
+        }
+        if (!have_last || name != last_name) {
+          const auto [it, inserted] = chunk.index.try_emplace(name, chunk.series.size());
+          if (inserted) {
+            chunk.names.push_back(name);
+            chunk.series.emplace_back();
+          }
+          last = it->second;
+          last_name = name;
+          have_last = true;
+        }
+        chunk.series[last].push_back(candle);
+      });
+}
+
+}  // namespace
+
+std::vector<SymbolCandles> read_symbol_candles_csv(const std::string& path, std::size_t threads) {
+  const MappedFile file(path);
+  if (!file.is_open()) {
+    return {};
+  }
+  const char* const end = file.data() + file.size();
+  const char* cursor = file.data();
+  std::string_view header;
+  while (cursor < end && header.empty()) {
+    const void* nl = std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor));
+    const char* line_end = nl != nullptr ? static_cast<const char*>(nl) : end;
+    header = trim(std::string_view(cursor, static_cast<std::size_t>(line_end - cursor)));
+    cursor = line_end == end ? end : line_end + 1;
+  }
+  const auto plan = plan_from_header(header);
+  const auto symbol = symbol_column(header);
+  if (!plan || !symbol || *symbol >= kMaxMappedColumns || plan->slots[*symbol] != kSkipColumn) {
+    return {};
+  }
+  ColumnSlots slots = plan->slots;
+  slots[*symbol] = static_cast<std::uint8_t>(kSymbolSlot);
+  const std::size_t min_fields = std::max(plan->min_fields, *symbol + 1);
+
+  const char* const body = cursor;
+  const std::size_t body_size = static_cast<std::size_t>(end - body);
+  const std::size_t workers = resolve_threads(threads, body_size);
+  std::vector<const char*> bounds(workers + 1);
+  for (std::size_t w = 0; w <= workers; ++w) {
+    bounds[w] = align_to_line(body + body_size * w / workers, body, end);
+  }
+  std::vector<SymbolChunk> chunks(workers);
+  std::vector<std::thread> pool;
+  for (std::size_t w = 1; w < workers; ++w) {
+    pool.emplace_back(
+        [&, w] { parse_symbol_rows(bounds[w], bounds[w + 1], slots, min_fields, chunks[w]); });
+  }
+  parse_symbol_rows(bounds[0], bounds[1], slots, min_fields, chunks[0]);
+  for (auto& worker : pool) {
+    worker.join();
+  }
+
+  std::vector<std::string_view> names;
+  for (const auto& chunk : chunks) {
+    names.insert(names.end(), chunk.names.begin(), chunk.names.end());
+  }
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+
+  // local[w][s]: the buffer of chunk w holding symbol s, if any.
+  constexpr std::size_t kAbsent = static_cast<std::size_t>(-1);
+  std::vector<std::vector<std::size_t>> local(workers,
+                                              std::vector<std::size_t>(names.size(), kAbsent));
+  for (std::size_t w = 0; w < workers; ++w) {
+    for (std::size_t k = 0; k < chunks[w].names.size(); ++k) {
+      const auto it = std::lower_bound(names.begin(), names.end(), chunks[w].names[k]);
+      local[w][static_cast<std::size_t>(it - names.begin())] = k;
+    }
+  }
+
+  std::vector<SymbolCandles> out(names.size());
+  auto stitch = [&](std::size_t first) {
+    for (std::size_t s = first; s < names.size(); s += workers) {
+      out[s].symbol.assign(names[s]);
+      std::size_t total = 0;
+      for (std::size_t w = 0; w < workers; ++w) {
+        if (local[w][s] != kAbsent) total += chunks[w].series[local[w][s]].size();
+      }
+      out[s].candles.reserve(total);
+      for (std::size_t w = 0; w < workers; ++w) {
+        if (local[w][s] == kAbsent) continue;
+        const auto& part = chunks[w].series[local[w][s]];
+        out[s].candles.insert(out[s].candles.end(), part.begin(), part.end());
+      }
+    }
+  };
+  pool.clear();
+  for (std::size_t w = 1; w < workers; ++w) {
+    pool.emplace_back(stitch, w);
+  }
+  stitch(0);
+  for (auto& worker : pool) {
+    worker.join();
+  }
+  return out;
+}
+
 }  // namespace lwti
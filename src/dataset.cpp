@@ -0,0 +1,243 @@
+#include "io/dataset.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <utility>
+
+#include "core/temp_path.hpp"
+#include "io/candle_store.hpp"
+#include "io/mapped_file.hpp"
+#include "io/parallel.hpp"
+
+namespace lwti {
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kMagic[8] = {'L', 'W', 'T', 'I', 'C', 'A', 'T', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kEndianTag = 0x01020304;
+
+struct CatalogHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t endian_tag;
+  std::uint64_t count;
+  std::uint64_t reserved;
+};
+static_assert(sizeof(CatalogHeader) == 32);
+
+struct CatalogEntry {
+  char symbol[DatasetPartition::kMaxSymbolChars + 1];  // zero padded
+  std::int32_t year;
+  std::int32_t month;
+  std::uint64_t rows;
+  std::int64_t first;
+  std::int64_t last;
+};
+static_assert(sizeof(CatalogEntry) == 64);
+
+bool catalog_order(const DatasetPartition& a, const DatasetPartition& b) {
+  return a.symbol != b.symbol ? a.symbol < b.symbol : a.month < b.month;
+}
+
+bool write_catalog(const std::string& root, const std::vector<DatasetPartition>& partitions) {
+  CatalogHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endian_tag = kEndianTag;
+  header.count = partitions.size();
+
+  const std::string path = dataset_catalog_path(root);
+  const std::string tmp_path = temp_path_for(path);
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& p : partitions) {
+      CatalogEntry entry{};
+      std::memcpy(entry.symbol, p.symbol.data(), p.symbol.size());
+      entry.year = p.month.year;
+      entry.month = p.month.month;
+      entry.rows = p.rows;
+      entry.first = p.first;
+      entry.last = p.last;
+      out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+    if (!out) {
+      out.close();
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+}  // namespace
+
+bool valid_symbol(const std::string& symbol) {
+  return !symbol.empty() && symbol.size() <= DatasetPartition::kMaxSymbolChars &&
+         symbol.find('/') == std::string::npos && symbol != "." && symbol != "..";
+}
+
+std::string dataset_catalog_path(const std::string& root) {
+  return (fs::path(root) / "catalog.lwtd").string();
+}
+
+std::string dataset_partition_path(const std::string& root, const DatasetPartition& partition) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%04d/%02d.lwts", partition.month.year,
+                partition.month.month);
+  return (fs::path(root) / partition.symbol / name).string();
+}
+
+std::optional<std::vector<DatasetPartition>> read_dataset_catalog(const std::string& root) {
+  const MappedFile file(dataset_catalog_path(root));
+  if (!file.is_open() || file.size() < sizeof(CatalogHeader)) {
+    return std::nullopt;
+  }
+  CatalogHeader header{};
+  std::memcpy(&header, file.data(), sizeof(header));
+  // Bounded by division first so a crafted count cannot wrap the product.
+  const std::size_t body = file.size() - sizeof(CatalogHeader);
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+      header.endian_tag != kEndianTag || header.count > body / sizeof(CatalogEntry) ||
+      body != header.count * sizeof(CatalogEntry)) {
+    return std::nullopt;
+  }
+  std::vector<DatasetPartition> partitions(header.count);
+  for (std::size_t i = 0; i < partitions.size(); ++i) {
+    CatalogEntry entry;
+    std::memcpy(&entry, file.data() + sizeof(CatalogHeader) + i * sizeof(CatalogEntry),
+                sizeof(entry));
+    entry.symbol[DatasetPartition::kMaxSymbolChars] = '\0';
+    partitions[i] = {entry.symbol, {entry.year, entry.month}, entry.rows, entry.first, entry.last};
+  }
+  return partitions;
+}
+
+bool write_dataset(const std::string& root, const std::vector<SymbolCandles>& series,
+                   std::size_t threads) {
+  std::vector<DatasetPartition> written;
+  std::vector<std::vector<Candle>> contents;
+  for (const auto& [symbol, candles] : series) {
+    if (!valid_symbol(symbol)) {
+      return false;
+    }
+    std::map<CivilMonth, std::vector<Candle>> months;
+    for (const auto& candle : candles) {
+      months[month_of(candle.timestamp)].push_back(candle);
+    }
+    for (auto& [month, bars] : months) {
+      const auto [lo, hi] = std::minmax_element(
+          bars.begin(), bars.end(),
+          [](const Candle& a, const Candle& b) { return a.timestamp < b.timestamp; });
+      written.push_back({symbol, month, bars.size(), lo->timestamp, hi->timestamp});
+      contents.push_back(std::move(bars));
+    }
+  }
+
+  std::error_code ec;
+  for (const auto& partition : written) {
+    fs::create_directories(fs::path(dataset_partition_path(root, partition)).parent_path(), ec);
+    if (ec) {
+      return false;
+    }
+  }
+  std::atomic<bool> ok{true};
+  run_parallel(written.size(), threads, [&](std::size_t i) {
+    if (!write_candle_store(dataset_partition_path(root, written[i]), contents[i])) {
+      ok = false;
+    }
+  });
+  if (!ok) {
+    return false;
+  }
+
+  auto catalog = read_dataset_catalog(root).value_or(std::vector<DatasetPartition>{});
+  std::sort(written.begin(), written.end(), catalog_order);
+  catalog.erase(std::remove_if(catalog.begin(), catalog.end(),
+                               [&](const DatasetPartition& p) {
+                                 return std::binary_search(written.begin(), written.end(), p,
+                                                           catalog_order);
+                               }),
+                catalog.end());
+  catalog.insert(catalog.end(), written.begin(), written.end());
+  std::sort(catalog.begin(), catalog.end(), catalog_order);
+  return write_catalog(root, catalog);
+}
+
+std::vector<DatasetPartition> prune_partitions(const std::vector<DatasetPartition>& catalog,
+                                               const std::vector<std::string>& symbols,
+                                               const TimeRange& range) {
+  std::vector<DatasetPartition> kept;
+  for (const auto& partition : catalog) {
+    const bool wanted = symbols.empty() ||
+                        std::find(symbols.begin(), symbols.end(), partition.symbol) !=
+                            symbols.end();
+    if (wanted && range.overlaps(partition.first, partition.last)) {
+      kept.push_back(partition);
+    }
+  }
+  return kept;
+}
+
+std::vector<SymbolCandles> load_dataset(const std::string& root,
+                                        const std::vector<std::string>& symbols,
+                                        const TimeRange& range, std::size_t threads) {
+  const auto catalog = read_dataset_catalog(root);
+  if (!catalog) {
+    return {};
+  }
+  const auto partitions = prune_partitions(*catalog, symbols, range);
+  std::vector<std::vector<Candle>> parts(partitions.size());
+  run_parallel(partitions.size(), threads, [&](std::size_t i) {
+    parts[i] = read_candle_store(dataset_partition_path(root, partitions[i]), range)
+                   .value_or(std::vector<Candle>{});
+  });
+
+  // The catalog order puts every symbol's months next to each other.
+  std::vector<SymbolCandles> out;
+  for (std::size_t i = 0; i < partitions.size(); ++i) {
+    if (out.empty() || out.back().symbol != partitions[i].symbol) {
+      out.push_back({partitions[i].symbol, {}});
+    }
+    auto& candles = out.back().candles;
+    candles.insert(candles.end(), parts[i].begin(), parts[i].end());
+  }
+  return out;
+}
+
+DatasetCandleSource::DatasetCandleSource(std::string root,
+                                         std::vector<DatasetPartition> partitions,
+                                         const TimeRange& range)
+    : root_(std::move(root)), partitions_(std::move(partitions)), range_(range) {}
+
+bool DatasetCandleSource::next(std::vector<Candle>& batch) {
+  while (true) {
+    if (current_ && current_->next(batch)) {
+      return true;
+    }
+    if (next_partition_ == partitions_.size()) {
+      current_.reset();
+      batch.clear();
+      return false;
+    }
+    current_ = std::make_unique<StoreCandleSource>(
+        dataset_partition_path(root_, partitions_[next_partition_++]), range_);
+  }
+}
+
+}  // namespace lwti
@@ -0,0 +1,85 @@
+#include "io/fingerprint.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "io/mapped_file.hpp"
+
+namespace lwti {
+namespace {
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+
+std::uint64_t rotl(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+std::uint64_t round(std::uint64_t acc, std::uint64_t input) {
+  return rotl(acc + input * kPrime2, 31) * kPrime1;
+}
+
+std::uint64_t load_word(const char* p) {
+  std::uint64_t word;
+  std::memcpy(&word, p, sizeof(word));
+  return word;
+}
+
+}  // namespace
+
+std::uint64_t hash_bytes(const char* data, std::size_t size) {
+  std::uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+  const char* p = data;
+  const char* const end = data + size;
+  for (; end - p >= 32; p += 32) {
+    lanes[0] = round(lanes[0], load_word(p));
+    lanes[1] = round(lanes[1], load_word(p + 8));
+    lanes[2] = round(lanes[2], load_word(p + 16));
+    lanes[3] = round(lanes[3], load_word(p + 24));
+  }
+  std::uint64_t h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) +
+                    rotl(lanes[3], 18) + static_cast<std::uint64_t>(size);
+  for (; end - p >= 8; p += 8) {
+    h = rotl(h ^ round(0, load_word(p)), 27) * kPrime1 + kPrime3;
+  }
+  for (; p < end; ++p) {
+    h = rotl(h ^ (static_cast<unsigned char>(*p) * kPrime3), 11) * kPrime1;
+  }
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+std::optional<SourceFingerprint> stat_fingerprint(const std::string& path) {
+  struct stat st {};
+  if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+    return std::nullopt;
+  }
+  SourceFingerprint fp;
+  fp.size = static_cast<std::uint64_t>(st.st_size);
+  fp.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 +
+                static_cast<std::int64_t>(st.st_mtim.tv_nsec);
+  return fp;
+}
+
+std::optional<SourceFingerprint> sampled_fingerprint(const std::string& path) {
+  constexpr std::size_t kSample = 64 << 10;
+  auto fp = stat_fingerprint(path);
+  if (!fp) {
+    return std::nullopt;
+  }
+  const MappedFile file(path);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  const std::size_t sample = std::min(kSample, file.size());
+  fp->hash = hash_bytes(file.data(), sample) ^
+             rotl(hash_bytes(file.data() + file.size() - sample, sample), 31);
+  return fp;
+}
+
+}  // namespace lwti
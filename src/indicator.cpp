@@ -2,20 +2,24 @@
 
 #include <algorithm>
 #include <cmath>
-#include <deque>
+
+#include "core/state_codec.hpp"
 
 namespace lwti {
 namespace {
 
-double typical_price(const Candle& c) {
-  return (c.high + c.low + c.close) / 3.0;
+template <typename Scalar>
+Scalar typical_price(double high, double low, double close) {
+  return static_cast<Scalar>((high + low + close) / 3.0);
 }
 
 std::size_t clamp_period(std::size_t value) { return std::max<std::size_t>(1, value); }
 
 }  // namespace
 
-LiquidityWeightedTrendIndicator::LiquidityWeightedTrendIndicator(IndicatorConfig config)
+template <typename Scalar>
+BasicLiquidityWeightedTrendIndicator<Scalar>::BasicLiquidityWeightedTrendIndicator(
+    IndicatorConfig config)
     : config_(config) {
   config_.trend_period = clamp_period(config_.trend_period);
   config_.momentum_lookback = clamp_period(config_.momentum_lookback);
@@ -24,112 +28,167 @@ LiquidityWeightedTrendIndicator::LiquidityWeightedTrendIndicator(IndicatorConfig
   config_.volume_floor = std::max(0.1, config_.volume_floor);
 }
 
-std::vector<IndicatorPoint> LiquidityWeightedTrendIndicator::compute(
-    const std::vector<Candle>& candles) const {
-  if (candles.empty()) {
-    return {};
+template <typename Scalar>
+auto BasicLiquidityWeightedTrendIndicator<Scalar>::compute(
+    const std::vector<Candle>& candles) const -> std::vector<Point> {
+  std::vector<Point> result;
+  result.reserve(candles.size());
+  Stream state = stream();
+  for (const Candle& c : candles) {
+    result.push_back(state.update(c));
   }
+  return result;
+}
 
-  const double alpha = 2.0 / (static_cast<double>(config_.trend_period) + 1.0);
-  std::vector<IndicatorPoint> result;
-  result.reserve(candles.size());
+template <typename Scalar>
+auto BasicLiquidityWeightedTrendIndicator<Scalar>::compute(const CandleSeries& series) const
+    -> std::vector<Point> {
+  std::vector<Point> result(series.size());
+  compute(series.high, series.low, series.close, series.volume, result);
+  return result;
+}
 
-  std::deque<double> volume_window;
-  double volume_sum = 0.0;
+template <typename Scalar>
+std::size_t BasicLiquidityWeightedTrendIndicator<Scalar>::compute(
+    std::span<const double> high, std::span<const double> low, std::span<const double> close,
+    std::span<const double> volume, std::span<Point> out) const {
+  const std::size_t n =
+      std::min({high.size(), low.size(), close.size(), volume.size(), out.size()});
+  Stream state = stream();
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = state.update(high[i], low[i], close[i], volume[i]);
+  }
+  return n;
+}
 
-  std::deque<double> return_window;
-  double ret_sum = 0.0;
-  double ret_sq_sum = 0.0;
+template <typename Scalar>
+BasicLiquidityWeightedTrendIndicator<Scalar>::Stream::Stream(const IndicatorConfig& config)
+    : config_(config),
+      alpha_(static_cast<Scalar>(2.0 / (static_cast<double>(config.trend_period) + 1.0))) {}
 
-  std::vector<double> lw_history;
-  lw_history.reserve(candles.size());
+template <typename Scalar>
+auto BasicLiquidityWeightedTrendIndicator<Scalar>::Stream::update(const Candle& c) -> Point {
+  return update(c.high, c.low, c.close, c.volume);
+}
 
-  double prev_tp = typical_price(candles.front());
-  double lw_ema = typical_price(candles.front());
+template <typename Scalar>
+auto BasicLiquidityWeightedTrendIndicator<Scalar>::Stream::update(double high, double low,
+                                                                  double close, double volume)
+    -> Point {
+  const std::size_t i = index_++;
+  const Scalar tp = typical_price<Scalar>(high, low, close);
+  const Scalar vol = static_cast<Scalar>(volume);
+  const Scalar volume_floor = static_cast<Scalar>(config_.volume_floor);
+  if (i == 0) {
+    prev_tp_ = tp;
+    lw_ema_ = tp;
+  }
 
-  for (std::size_t i = 0; i < candles.size(); ++i) {
-    const Candle& c = candles[i];
-    const double tp = typical_price(c);
+  // Maintain rolling volume stats.
+  volume_window_.push_back(vol);
+  volume_sum_.add(vol);
+  if (volume_window_.size() > config_.trend_period) {
+    volume_sum_.add(-volume_window_.front());
+    volume_window_.pop_front();
+  }
+  const Scalar avg_volume = volume_window_.empty()
+                                ? Scalar{0}
+                                : volume_sum_.value() / static_cast<Scalar>(volume_window_.size());
+  Scalar weight = volume_floor;
+  if (avg_volume > Scalar{0}) {
+    weight = std::max(volume_floor, vol / avg_volume);
+  }
 
-    // Maintain rolling volume stats.
-    volume_window.push_back(c.volume);
-    volume_sum += c.volume;
-    if (volume_window.size() > config_.trend_period) {
-      volume_sum -= volume_window.front();
-      volume_window.pop_front();
-    }
-    const double avg_volume =
-        volume_window.empty() ? 0.0 : volume_sum / static_cast<double>(volume_window.size());
-    double weight = config_.volume_floor;
-    if (avg_volume > 0.0) {
-      weight = std::max(config_.volume_floor, c.volume / avg_volume);
-    }
+  // Trend smoothing with volume weight.
+  const Scalar effective_alpha = std::min(Scalar{1}, alpha_ * weight);
+  if (i == 0) {
+    lw_ema_ = tp;
+  } else {
+    lw_ema_ = effective_alpha * tp + (Scalar{1} - effective_alpha) * lw_ema_;
+  }
+  lw_history_.push_back(lw_ema_);
+  if (lw_history_.size() > config_.momentum_lookback + 1) {
+    lw_history_.pop_front();
+  }
 
-    // Trend smoothing with volume weight.
-    const double effective_alpha = std::min(1.0, alpha * weight);
-    if (i == 0) {
-      lw_ema = tp;
+  // Momentum relative to past smoothed price.
+  Scalar momentum{0};
+  if (i >= config_.momentum_lookback) {
+    const Scalar base = lw_history_.front();
+    if (std::abs(base) > Scalar(1e-9)) {
+      momentum = (lw_ema_ - base) / base;
     } else {
-      lw_ema = effective_alpha * tp + (1.0 - effective_alpha) * lw_ema;
-    }
-    lw_history.push_back(lw_ema);
-
-    // Momentum relative to past smoothed price.
-    double momentum = 0.0;
-    if (i >= config_.momentum_lookback) {
-      const double base = lw_history[i - config_.momentum_lookback];
-      if (std::abs(base) > 1e-9) {
-        momentum = (lw_ema - base) / base;
-      } else {
-        momentum = lw_ema - base;
-      }
+      momentum = lw_ema_ - base;
     }
+  }
 
-    // Rolling volatility on simple returns of typical price.
-    if (i > 0) {
-      double ret = 0.0;
-      if (std::abs(prev_tp) > 1e-9) {
-        ret = (tp - prev_tp) / prev_tp;
-      }
-      return_window.push_back(ret);
-      ret_sum += ret;
-      ret_sq_sum += ret * ret;
-      if (return_window.size() > config_.volatility_window) {
-        const double removed = return_window.front();
-        return_window.pop_front();
-        ret_sum -= removed;
-        ret_sq_sum -= removed * removed;
-      }
+  // Rolling volatility on simple returns of typical price.
+  if (i > 0) {
+    Scalar ret{0};
+    if (std::abs(prev_tp_) > Scalar(1e-9)) {
+      ret = (tp - prev_tp_) / prev_tp_;
     }
-    prev_tp = tp;
-    double variance = 0.0;
-    if (!return_window.empty()) {
-      const double mean = ret_sum / static_cast<double>(return_window.size());
-      variance = ret_sq_sum / static_cast<double>(return_window.size()) - mean * mean;
-      if (variance < 0.0) {
-        variance = 0.0;
-      }
+    return_window_.push_back(ret);
+    if (return_window_.size() > config_.volatility_window) {
+      returns_.replace(return_window_.front(), ret, config_.volatility_window);
+      return_window_.pop_front();
+    } else {
+      returns_.push(ret, return_window_.size());
     }
-    const double volatility = std::sqrt(variance);
+  }
+  prev_tp_ = tp;
+  const Scalar volatility = std::sqrt(returns_.variance(return_window_.size()));
+
+  // Signal gating by volatility.
+  const Scalar threshold = static_cast<Scalar>(config_.threshold);
+  Scalar gate = volatility * threshold;
+  if (gate < Scalar(1e-8)) {
+    gate = threshold * Scalar(1e-4);
+  }
 
-    // Signal gating by volatility.
-    double gate = volatility * config_.threshold;
-    if (gate < 1e-8) {
-      gate = config_.threshold * 1e-4;
-    }
+  Signal signal = Signal::Flat;
+  if (momentum > gate) {
+    signal = Signal::Long;
+  } else if (momentum < -gate) {
+    signal = Signal::Short;
+  }
 
-    Signal signal = Signal::Flat;
-    if (momentum > gate) {
-      signal = Signal::Long;
-    } else if (momentum < -gate) {
-      signal = Signal::Short;
-    }
+  return {lw_ema_, momentum, volatility, signal};
+}
 
-    result.push_back(
-        {i, c.timestamp, lw_ema, momentum, volatility, signal});
-  }
+template <typename Scalar>
+void BasicLiquidityWeightedTrendIndicator<Scalar>::Stream::save(StateWriter& out) const {
+  out.put(config_.trend_period);
+  out.put(config_.momentum_lookback);
+  out.put(config_.volatility_window);
+  out.put(config_.threshold);
+  out.put(config_.volume_floor);
+  out.put(index_);
+  out.put(volume_window_);
+  out.put(volume_sum_.sum);
+  out.put(volume_sum_.carry);
+  out.put(return_window_);
+  out.put(returns_.mean.sum);
+  out.put(returns_.mean.carry);
+  out.put(returns_.m2.sum);
+  out.put(returns_.m2.carry);
+  out.put(lw_history_);
+  out.put(prev_tp_);
+  out.put(lw_ema_);
+}
 
-  return result;
+template <typename Scalar>
+bool BasicLiquidityWeightedTrendIndicator<Scalar>::Stream::restore(StateReader& in) {
+  return in.expect(config_.trend_period) && in.expect(config_.momentum_lookback) &&
+         in.expect(config_.volatility_window) && in.expect(config_.threshold) &&
+         in.expect(config_.volume_floor) && in.get(index_) && in.get(volume_window_) &&
+         in.get(volume_sum_.sum) && in.get(volume_sum_.carry) && in.get(return_window_) &&
+         in.get(returns_.mean.sum) && in.get(returns_.mean.carry) && in.get(returns_.m2.sum) &&
+         in.get(returns_.m2.carry) && in.get(lw_history_) && in.get(prev_tp_) &&
+         in.get(lw_ema_);
 }
 
+template class BasicLiquidityWeightedTrendIndicator<float>;
+template class BasicLiquidityWeightedTrendIndicator<double>;
+
 }  // namespace lwti
@@ -0,0 +1,70 @@
+#include "io/line_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace lwti {
+
+LineReader::LineReader(const std::string& path, std::size_t buffer_bytes, std::uint64_t start,
+                       bool complete_only, ReadAhead::Backend backend)
+    : input_(path, start, backend),
+      buffer_(std::max<std::size_t>(buffer_bytes, 4096)),
+      position_(start),
+      complete_only_(complete_only) {}
+
+bool LineReader::next(const char*& begin, const char*& end) {
+  // Keep the partial line left over from the previous call.
+  position_ += consumed_;
+  filled_ -= consumed_;
+  std::memmove(buffer_.data(), buffer_.data() + consumed_, filled_);
+  consumed_ = 0;
+
+  while (true) {
+    if (!input_.is_open() || (eof_ && filled_ == 0)) {
+      return false;
+    }
+    if (!eof_) {
+      const std::size_t want = buffer_.size() - filled_;
+      const std::size_t got = input_.read(buffer_.data() + filled_, want);
+      filled_ += got;
+      if (got < want) {
+        eof_ = true;
+      }
+    }
+
+    const char* first = buffer_.data();
+    const char* const last = first + filled_;
+    // Only complete lines are handed out; the tail waits for the next read.
+    const char* stop = last;
+    if (!eof_ || complete_only_) {
+      const auto last_nl = std::find(std::make_reverse_iterator(last),
+                                     std::make_reverse_iterator(first), '\n');
+      stop = last_nl.base();
+    }
+    if (stop == first) {
+      if (eof_) {
+        return false;  // only an unterminated line is left
+      }
+      if (filled_ == buffer_.size()) {
+        // A single line fills the whole buffer: drop it as malformed.
+        skipping_line_ = true;
+        position_ += filled_;
+        filled_ = 0;
+      }
+      continue;
+    }
+
+    consumed_ = static_cast<std::size_t>(stop - first);
+    if (skipping_line_) {
+      const char* nl = std::find(first, stop, '\n');
+      first = nl == stop ? stop : nl + 1;
+      skipping_line_ = nl == stop;
+    }
+    begin = first;
+    end = stop;
+    return true;
+  }
+}
+
+}  // namespace lwti
@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -8,9 +10,18 @@
 #include <vector>
 
 #include "backtest/backtester.hpp"
+#include "backtest/pipeline.hpp"
 #include "config/run_config.hpp"
-#include "csv_reader.hpp"
+#include "core/candle_series.hpp"
+#include "core/signal_column.hpp"
+#include "core/state_codec.hpp"
+#include "core/time.hpp"
 #include "indicator.hpp"
+#include "io/candle_loader.hpp"
+#include "io/candle_store.hpp"
+#include "io/dataset.hpp"
+#include "io/fingerprint.hpp"
+#include "io/mapped_file.hpp"
 #include "indicators/regime.hpp"
 #include "indicators/vwap_band.hpp"
 #include "strategy/composite_strategy.hpp"
@@ -21,17 +32,47 @@ struct CliOptions {
   std::optional<std::string> config_path;
   std::optional<std::string> export_signals;
   std::optional<std::string> report_path;
+  std::optional<std::string> write_store;
+  std::optional<std::string> follow_state;
+  std::optional<std::string> dataset;
+  std::optional<std::string> write_dataset;
+  std::optional<std::vector<std::string>> symbols;
+  std::optional<std::size_t> threads;
+  bool stream{false};
+  bool no_cache{false};
+  bool validate{false};
+  bool by_symbol{false};
+  bool csv_index{false};
+  std::optional<std::vector<std::string>> tick_bars;
+  std::optional<lwti::Timestamp> resample;
+  std::optional<lwti::Timestamp> from;
+  std::optional<lwti::Timestamp> to;
   lwti::RunConfig fallback;
 };
 
 void print_usage(std::string_view exec) {
   std::cerr << "Usage: " << exec << " [--config <file>]"
-            << " [--input <file>] [--export-signals <file>] [--report <file>]\n"
+            << " [--input <file|dir|glob>]... [--export-signals <file>] [--report <file>]"
+            << " [--threads N] [--stream] [--no-cache] [--tick-bars 1s,1m,...]"
+            << " [--resample 5m] [--write-store <file.lwts>] [--follow <state>]"
+            << " [--from <time>] [--to <time>] [--validate] [--by-symbol] [--csv-index]"
+            << " [--dataset <dir>] [--symbols A,B,...] [--write-dataset <dir>]\n"
             << "Optional overrides: --trend-period N --momentum-lookback N"
             << " --volatility-window N --threshold X --volume-floor X"
             << " --vwap-window N --vwap-band-dev X --regime-window N --high-vol-threshold X"
             << " --lwti-weight X --vwap-weight X --max-position X"
-            << " --risk-per-trade X --fee-bps X --slippage-bps X\n";
+            << " --risk-per-trade X --fee-bps X --slippage-bps X --tick-size X --lot-size X\n";
+}
+
+std::vector<std::string> split_list(std::string_view list) {
+  std::vector<std::string> items;
+  while (!list.empty()) {
+    const std::size_t comma = list.find(',');
+    if (comma != 0) items.emplace_back(list.substr(0, comma));
+    if (comma == std::string_view::npos) break;
+    list.remove_prefix(comma + 1);
+  }
+  return items;
 }
 
 std::optional<CliOptions> parse_args(int argc, char* argv[]) {
@@ -47,13 +88,55 @@ std::optional<CliOptions> parse_args(int argc, char* argv[]) {
       opts.config_path = next();
       if (!opts.config_path) return std::nullopt;
     } else if (arg == "--input") {
-      opts.fallback.data.input_path = next().value_or("");
+      if (auto path = next()) {
+        opts.fallback.data.inputs.push_back(*path);
+      }
     } else if (arg == "--export-signals") {
       opts.export_signals = next();
       if (!opts.export_signals) return std::nullopt;
     } else if (arg == "--report") {
       opts.report_path = next();
       if (!opts.report_path) return std::nullopt;
+    } else if (arg == "--write-store") {
+      opts.write_store = next();
+      if (!opts.write_store) return std::nullopt;
+    } else if (arg == "--follow") {
+      opts.follow_state = next();
+      if (!opts.follow_state) return std::nullopt;
+    } else if (arg == "--no-cache") {
+      opts.no_cache = true;
+    } else if (arg == "--stream") {
+      opts.stream = true;
+    } else if (arg == "--validate") {
+      opts.validate = true;
+    } else if (arg == "--by-symbol") {
+      opts.by_symbol = true;
+    } else if (arg == "--csv-index") {
+      opts.csv_index = true;
+    } else if (arg == "--dataset") {
+      opts.dataset = next();
+      if (!opts.dataset) return std::nullopt;
+    } else if (arg == "--write-dataset") {
+      opts.write_dataset = next();
+      if (!opts.write_dataset) return std::nullopt;
+    } else if (arg == "--symbols") {
+      const auto list = next();
+      if (!list) return std::nullopt;
+      opts.symbols = split_list(*list);
+    } else if (arg == "--tick-bars") {
+      const auto list = next();
+      if (!list) return std::nullopt;
+      opts.tick_bars = split_list(*list);
+    } else if (arg == "--resample") {
+      lwti::Timestamp period = 0;
+      if (!lwti::parse_duration(next().value_or(""), period)) return std::nullopt;
+      opts.resample = period;
+    } else if (arg == "--from" || arg == "--to") {
+      lwti::Timestamp bound = 0;
+      if (!lwti::parse_timestamp(next().value_or(""), bound)) return std::nullopt;
+      (arg == "--from" ? opts.from : opts.to) = bound;
+    } else if (arg == "--threads") {
+      opts.threads = std::stoul(next().value_or("1"));
     } else if (arg == "--trend-period") {
       opts.fallback.lwti.trend_period = std::stoul(next().value_or("0"));
     } else if (arg == "--momentum-lookback") {
@@ -84,6 +167,10 @@ std::optional<CliOptions> parse_args(int argc, char* argv[]) {
       opts.fallback.backtest.fee_bps = std::stod(next().value_or("0"));
     } else if (arg == "--slippage-bps") {
       opts.fallback.backtest.slippage_bps = std::stod(next().value_or("0"));
+    } else if (arg == "--tick-size") {
+      opts.fallback.backtest.tick_size = std::stod(next().value_or("0"));
+    } else if (arg == "--lot-size") {
+      opts.fallback.backtest.lot_size = std::stod(next().value_or("1"));
     } else if (arg == "--help" || arg == "-h") {
       print_usage(argv[0]);
       return std::nullopt;
@@ -92,17 +179,26 @@ std::optional<CliOptions> parse_args(int argc, char* argv[]) {
     }
   }
 
-  if (!opts.config_path && opts.fallback.data.input_path.empty()) {
+  if (!opts.config_path && opts.fallback.data.inputs.empty() && !opts.dataset) {
     return std::nullopt;
   }
 
   return opts;
 }
 
+std::string describe_inputs(const lwti::DataConfig& data) {
+  std::string joined;
+  for (const auto& input : data.inputs) {
+    if (!joined.empty()) joined += ", ";
+    joined += input;
+  }
+  return joined;
+}
+
 std::ostream& prepare_output(const std::optional<std::string>& path,
-                             std::ofstream& owned_stream) {
+                             std::ofstream& owned_stream, bool append = false) {
   if (path.has_value() && *path != "stdout") {
-    owned_stream.open(*path);
+    owned_stream.open(*path, append ? std::ios::app : std::ios::out);
     if (owned_stream.is_open()) {
       return owned_stream;
     }
@@ -111,7 +207,24 @@ std::ostream& prepare_output(const std::optional<std::string>& path,
   return std::cout;
 }
 
-void write_signals(const std::vector<lwti::Candle>& candles,
+void write_signal_header(std::ostream& out) {
+  out << std::fixed << std::setprecision(6);
+  out << "timestamp,close,lwti_momentum,lwti_signal,vwap,upper,lower,vwap_signal,"
+         "regime_vol,strategy_score,strategy_signal\n";
+}
+
+void write_signal_row(std::ostream& out, lwti::Timestamp timestamp, double close,
+                      const lwti::IndicatorPoint& l, const lwti::VwapBandPoint& v,
+                      const lwti::RegimePoint& r, const lwti::StrategyPoint& s) {
+  char ts[lwti::kMaxTimestampChars];
+  out.write(ts, static_cast<std::streamsize>(lwti::format_timestamp(timestamp, ts)));
+  out << ',' << close << ',' << l.momentum << ','
+      << lwti::signal_to_string(l.signal) << ',' << v.vwap << ',' << v.upper << ',' << v.lower
+      << ',' << lwti::signal_to_string(v.signal) << ',' << r.realized_vol << ',' << s.score
+      << ',' << lwti::signal_to_string(s.signal) << '\n';
+}
+
+void write_signals(const lwti::CandleSeries& series,
                    const std::vector<lwti::IndicatorPoint>& lwti_points,
                    const std::vector<lwti::VwapBandPoint>& vwap_points,
                    const std::vector<lwti::RegimePoint>& regime_points,
@@ -123,23 +236,19 @@ void write_signals(const std::vector<lwti::Candle>& candles,
   std::ofstream out_file;
   std::ostream& out = prepare_output(path, out_file);
   const std::size_t n =
-      std::min({candles.size(), lwti_points.size(), vwap_points.size(), strat_points.size(),
+      std::min({series.size(), lwti_points.size(), vwap_points.size(), strat_points.size(),
                 regime_points.size()});
 
-  out << std::fixed << std::setprecision(6);
-  out << "timestamp,close,lwti_momentum,lwti_signal,vwap,upper,lower,vwap_signal,"
-         "regime_vol,strategy_score,strategy_signal\n";
+  write_signal_header(out);
   for (std::size_t i = 0; i < n; ++i) {
-    out << candles[i].timestamp << ',' << candles[i].close << ',' << lwti_points[i].momentum
-        << ',' << lwti::signal_to_string(lwti_points[i].signal) << ','
-        << vwap_points[i].vwap << ',' << vwap_points[i].upper << ',' << vwap_points[i].lower
-        << ',' << lwti::signal_to_string(vwap_points[i].signal) << ','
-        << regime_points[i].realized_vol << ',' << strat_points[i].score << ','
-        << lwti::signal_to_string(strat_points[i].signal) << '\n';
+    write_signal_row(out, series.timestamp[i], series.close[i], lwti_points[i], vwap_points[i],
+                     regime_points[i], strat_points[i]);
   }
 }
 
-void write_report(const lwti::BacktestResult& result, const std::optional<std::string>& path) {
+void write_report(const lwti::BacktestResult& result, const std::optional<std::string>& path,
+                  const lwti::ValidationReport* quality = nullptr,
+                  const lwti::SignalColumn* signals = nullptr) {
   if (!path) {
     return;
   }
@@ -156,6 +265,365 @@ void write_report(const lwti::BacktestResult& result, const std::optional<std::s
   out << "max_drawdown_pct=" << result.max_drawdown * 100.0 << "\n";
   out << "trades=" << result.trades << "\n";
   out << "win_rate_pct=" << result.win_rate * 100.0 << "\n";
+  if (quality) {
+    out << "rows_checked=" << quality->rows << "\n";
+    out << "bad_high=" << quality->bad_high << "\n";
+    out << "bad_low=" << quality->bad_low << "\n";
+    out << "negative_volume=" << quality->negative_volume << "\n";
+    out << "zero_price=" << quality->zero_price << "\n";
+    out << "non_finite=" << quality->non_finite << "\n";
+    out << "out_of_order=" << quality->out_of_order << "\n";
+    out << "duplicates_dropped=" << quality->duplicates << "\n";
+  }
+  if (signals) {
+    const lwti::SignalCounts counts = signals->counts();
+    out << "long_bars=" << counts.long_bars << "\n";
+    out << "short_bars=" << counts.short_bars << "\n";
+    out << "flat_bars=" << counts.flat_bars << "\n";
+    out << "signal_changes=" << signals->transitions() << "\n";
+  }
+}
+
+void print_summary(const lwti::BacktestResult& backtest) {
+  std::cout << "# Backtest ending equity: " << backtest.ending_equity
+            << " | trades=" << backtest.trades
+            << " | win_rate=" << backtest.win_rate * 100.0 << "%\n";
+}
+
+void print_quality(const lwti::ValidationReport& quality) {
+  std::cout << "# Validation: rows=" << quality.rows << " | issues=" << quality.issues()
+            << " | out_of_order=" << quality.out_of_order
+            << " | duplicates_dropped=" << quality.duplicates << "\n";
+}
+
+// The bar-by-bar modes keep no trade log; the report only needs the counts.
+lwti::RunConfig bounded_config(const lwti::RunConfig& cfg) {
+  lwti::RunConfig bounded = cfg;
+  bounded.backtest.keep_trade_log = false;
+  return bounded;
+}
+
+void feed(lwti::Pipeline& pipeline, lwti::CandleSource& source, std::ostream* signals_out) {
+  std::vector<lwti::Candle> batch;
+  while (source.next(batch)) {
+    for (const auto& candle : batch) {
+      const auto step = pipeline.update(candle);
+      if (signals_out) {
+        write_signal_row(*signals_out, candle.timestamp, candle.close, step.lwti, step.vwap,
+                         step.regime, step.strategy);
+      }
+    }
+  }
+}
+
+// Pulls candles batch by batch and pushes each bar through every stage, so
+// nothing proportional to the series length is kept in memory.
+std::optional<lwti::BacktestResult> run_streaming(const lwti::RunConfig& cfg,
+                                                  lwti::CandleSource& source,
+                                                  const std::optional<std::string>& signals) {
+  std::ofstream signals_file;
+  std::ostream* signals_out = nullptr;
+  if (signals) {
+    signals_out = &prepare_output(signals, signals_file);
+    write_signal_header(*signals_out);
+  }
+
+  lwti::Pipeline pipeline(bounded_config(cfg));
+  feed(pipeline, source, signals_out);
+  if (pipeline.bars() == 0) {
+    return std::nullopt;
+  }
+  return pipeline.finish();
+}
+
+// Checkpoint of a follow run: where reading stopped, a hash of the file
+// prefix (to notice a rewritten file) and the pipeline state.
+constexpr std::uint64_t kFollowMagic = 0x574F4C4C4F465457;  // "LWTFOLLW"
+constexpr std::uint32_t kFollowVersion = 4;  // v3: vwap row index, v2: no ledger, v1: raw sums
+constexpr std::size_t kFollowPrefixBytes = 4096;
+
+std::uint64_t prefix_hash(const lwti::MappedFile& file, std::uint64_t offset) {
+  const std::size_t bytes = static_cast<std::size_t>(
+      std::min<std::uint64_t>({offset, kFollowPrefixBytes, file.size()}));
+  return lwti::hash_bytes(file.data(), bytes);
+}
+
+bool load_checkpoint(const std::string& state_path, const lwti::MappedFile& csv,
+                     lwti::CsvPosition& position, lwti::Pipeline& pipeline) {
+  const auto bytes = lwti::read_state_file(state_path);
+  if (!bytes) {
+    return false;
+  }
+  lwti::StateReader in(*bytes);
+  std::uint64_t offset = 0;
+  std::uint64_t hash = 0;
+  std::array<std::size_t, lwti::ColumnPlan::kFieldCount> columns{};
+  if (!in.expect(kFollowMagic) || !in.expect(kFollowVersion) || !in.get(offset) ||
+      !in.get(hash) || !in.get(position.header_resolved)) {
+    return false;
+  }
+  for (auto& column : columns) {
+    if (!in.get(column)) return false;
+  }
+  const auto plan = lwti::ColumnPlan::from_columns(columns);
+  if (!plan || offset > csv.size() || hash != prefix_hash(csv, offset)) {
+    return false;
+  }
+  position.offset = offset;
+  position.plan = *plan;
+  return pipeline.restore(in) && in.at_end();
+}
+
+bool save_checkpoint(const std::string& state_path, const lwti::MappedFile& csv,
+                     const lwti::CsvPosition& position, const lwti::Pipeline& pipeline) {
+  lwti::StateWriter out;
+  out.put(kFollowMagic);
+  out.put(kFollowVersion);
+  out.put(position.offset);
+  out.put(prefix_hash(csv, position.offset));
+  out.put(position.header_resolved);
+  for (const std::size_t column : position.plan.columns) {
+    out.put(column);
+  }
+  pipeline.save(out);
+  return lwti::write_state_file(state_path, out.bytes());
+}
+
+// Tail-follow over a CSV that keeps growing: resumes the checkpoint, feeds
+// only the rows appended since the last run, appends their signal rows and
+// rewrites the report from the carried-over state. Without a usable
+// checkpoint (first run, changed config, rewritten file) it starts over.
+int run_follow(const lwti::RunConfig& cfg, const CliOptions& opts) {
+  const auto files = lwti::resolve_inputs(cfg.data.inputs);
+  if (files.size() != 1 || lwti::is_candle_store(files.front()) || cfg.data.resample > 0 ||
+      !cfg.data.tick_bars.empty() || cfg.data.range.bounded()) {
+    std::cerr << "--follow needs a single CSV input without resampling, tick bars or a range\n";
+    return 1;
+  }
+  const std::string& path = files.front();
+  const std::string& state_path = cfg.data.follow_state;
+
+  const lwti::RunConfig run_cfg = bounded_config(cfg);
+  lwti::Pipeline pipeline(run_cfg);
+  lwti::CsvPosition from;
+  bool resumed = false;
+  {
+    const lwti::MappedFile csv(path);
+    resumed = csv.is_open() && load_checkpoint(state_path, csv, from, pipeline);
+  }
+  if (!resumed) {
+    pipeline = lwti::Pipeline(run_cfg);
+    from = {};
+  }
+
+  lwti::CsvCandleSource source(path, from);
+  if (!source.is_open()) {
+    std::cerr << "Cannot open input: " << path << "\n";
+    return 1;
+  }
+  std::ofstream signals_file;
+  std::ostream* signals_out = nullptr;
+  if (opts.export_signals) {
+    signals_out = &prepare_output(opts.export_signals, signals_file, resumed);
+    if (!resumed) {
+      write_signal_header(*signals_out);
+    }
+    *signals_out << std::fixed << std::setprecision(6);
+  }
+  feed(pipeline, source, signals_out);
+  signals_file.close();
+
+  const lwti::MappedFile csv(path);
+  if (!csv.is_open() || !save_checkpoint(state_path, csv, source.position(), pipeline)) {
+    std::cerr << "Failed to write follow state: " << state_path << "\n";
+  }
+  if (pipeline.bars() == 0) {
+    std::cerr << "No candles loaded from " << path << "\n";
+    return 1;
+  }
+  const auto backtest = pipeline.finish();
+  write_report(backtest, opts.report_path);
+  print_summary(backtest);
+  return 0;
+}
+
+// Callers build the series from a moved-from candle vector, so the
+// records are freed before the indicators allocate their outputs.
+lwti::BacktestResult run_batch(const lwti::RunConfig& cfg, const lwti::CandleSeries& series,
+                               const std::optional<std::string>& signals,
+                               const std::optional<std::string>& report,
+                               const lwti::ValidationReport* quality = nullptr) {
+  const auto lwti_points = lwti::LiquidityWeightedTrendIndicator(cfg.lwti).compute(series);
+  const auto vwap_points = lwti::VwapBandIndicator(cfg.vwap).compute(series);
+  const auto regime_points = lwti::VolatilityRegimeIndicator(cfg.regime).compute(series);
+  const auto strat_points =
+      lwti::CompositeStrategy(cfg.strategy).generate(lwti_points, vwap_points, regime_points);
+  const auto backtest = lwti::Backtester(cfg.backtest).run(series, strat_points);
+
+  write_signals(series, lwti_points, vwap_points, regime_points, strat_points, signals);
+  const lwti::SignalColumn strategy_signals = lwti::pack_signals(strat_points);
+  write_report(backtest, report, quality, &strategy_signals);
+  return backtest;
+}
+
+// out.csv -> out_1m.csv, so runs over several bar intervals keep apart.
+std::optional<std::string> with_suffix(const std::optional<std::string>& path,
+                                       const std::string& suffix) {
+  if (!path || *path == "stdout") {
+    return path;
+  }
+  const std::size_t slash = path->find_last_of('/');
+  const std::size_t dot = path->find_last_of('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    return *path + "_" + suffix;
+  }
+  return path->substr(0, dot) + "_" + suffix + path->substr(dot);
+}
+
+// Builds bars of each configured interval from tick inputs and runs the
+// pipeline on every series; the ticks are read once for all intervals.
+int run_tick_bars(const lwti::RunConfig& cfg, const CliOptions& opts) {
+  std::vector<lwti::Timestamp> intervals;
+  for (const auto& spec : cfg.data.tick_bars) {
+    lwti::Timestamp interval = 0;
+    if (!lwti::parse_duration(spec, interval)) {
+      std::cerr << "Invalid bar interval: " << spec << "\n";
+      return 1;
+    }
+    intervals.push_back(interval);
+  }
+
+  if (cfg.data.stream) {
+    if (intervals.size() != 1) {
+      std::cerr << "--stream builds a single bar interval at a time\n";
+      return 1;
+    }
+    auto source = lwti::open_tick_bar_source(cfg.data, intervals.front());
+    const auto backtest =
+        source ? run_streaming(cfg, *source, opts.export_signals) : std::nullopt;
+    if (!backtest) {
+      std::cerr << "No ticks loaded from " << describe_inputs(cfg.data) << "\n";
+      return 1;
+    }
+    write_report(*backtest, opts.report_path);
+    print_summary(*backtest);
+    return 0;
+  }
+
+  auto bars = lwti::load_tick_bars(cfg.data, intervals);
+  const bool several = bars.size() > 1;
+  for (std::size_t k = 0; k < bars.size(); ++k) {
+    const std::string& label = cfg.data.tick_bars[k];
+    if (bars[k].empty()) {
+      std::cerr << "No ticks loaded from " << describe_inputs(cfg.data) << "\n";
+      return 1;
+    }
+    const auto backtest =
+        run_batch(cfg, lwti::CandleSeries(std::move(bars[k])),
+                  several ? with_suffix(opts.export_signals, label) : opts.export_signals,
+                  several ? with_suffix(opts.report_path, label) : opts.report_path);
+    if (several) {
+      std::cout << "# bars=" << label << "\n";
+    }
+    print_summary(backtest);
+  }
+  return 0;
+}
+
+int save_dataset(const std::string& root, const std::vector<lwti::SymbolCandles>& series,
+                  std::size_t threads) {
+  if (!lwti::write_dataset(root, series, threads)) {
+    std::cerr << "Failed to write dataset: " << root << "\n";
+    return 1;
+  }
+  std::size_t rows = 0;
+  for (const auto& s : series) rows += s.candles.size();
+  std::cout << "# Wrote " << rows << " candles of " << series.size() << " symbols to " << root
+            << "\n";
+  return 0;
+}
+
+// Symbols become part of output file names; one that cannot (a '/' would
+// open a missing directory or escape the output one) is skipped when any
+// per-symbol file is written.
+bool symbol_usable(const CliOptions& opts, const std::string& symbol) {
+  const auto to_file = [](const std::optional<std::string>& path) {
+    return path && *path != "stdout";
+  };
+  if (lwti::valid_symbol(symbol) ||
+      !(to_file(opts.write_store) || to_file(opts.export_signals) || to_file(opts.report_path))) {
+    return true;
+  }
+  std::cerr << "Skipping symbol '" << symbol << "': not usable in an output file name\n";
+  return false;
+}
+
+// Runs every symbol of long-format inputs or a dataset as its own series;
+// outputs get the symbol as a suffix (signals_AAPL.csv).
+int run_by_symbol(const lwti::RunConfig& cfg, const CliOptions& opts) {
+  std::vector<lwti::ValidationReport> quality;
+  auto partitions = lwti::load_symbol_candles(cfg.data, &quality);
+  if (partitions.empty()) {
+    std::cerr << "No symbol rows loaded from "
+              << (cfg.data.dataset.empty() ? describe_inputs(cfg.data) : cfg.data.dataset)
+              << "\n";
+    return 1;
+  }
+  if (opts.write_dataset) {
+    return save_dataset(*opts.write_dataset, partitions, cfg.data.threads);
+  }
+  for (std::size_t k = 0; k < partitions.size(); ++k) {
+    auto& [symbol, candles] = partitions[k];
+    if (!symbol_usable(opts, symbol)) {
+      continue;
+    }
+    std::cout << "# symbol=" << symbol << "\n";
+    const lwti::ValidationReport* report = cfg.data.validate ? &quality[k] : nullptr;
+    if (report) {
+      print_quality(*report);
+    }
+    if (candles.empty()) {
+      continue;
+    }
+    if (opts.write_store) {
+      const auto path = *with_suffix(opts.write_store, symbol);
+      if (!lwti::write_candle_store(path, candles)) {
+        std::cerr << "Failed to write store: " << path << "\n";
+        return 1;
+      }
+      std::cout << "# Wrote " << candles.size() << " candles to " << path << "\n";
+      continue;
+    }
+    print_summary(run_batch(cfg, lwti::CandleSeries(std::move(candles)),
+                            with_suffix(opts.export_signals, symbol),
+                            with_suffix(opts.report_path, symbol), report));
+  }
+  return 0;
+}
+
+// Streams every selected symbol of the dataset through the pipeline one
+// block at a time; memory stays bounded by the block size, not by the
+// history length or the number of symbols.
+int run_dataset_streaming(const lwti::RunConfig& cfg, const CliOptions& opts) {
+  auto sources = lwti::open_dataset_sources(cfg.data);
+  if (sources.empty()) {
+    std::cerr << "No symbol rows loaded from " << cfg.data.dataset << "\n";
+    return 1;
+  }
+  for (auto& [symbol, source] : sources) {
+    if (!symbol_usable(opts, symbol)) {
+      continue;
+    }
+    const auto backtest =
+        run_streaming(cfg, *source, with_suffix(opts.export_signals, symbol));
+    std::cout << "# symbol=" << symbol << "\n";
+    if (!backtest) {
+      continue;
+    }
+    write_report(*backtest, with_suffix(opts.report_path, symbol));
+    print_summary(*backtest);
+  }
+  return 0;
 }
 
 }  // namespace
@@ -177,31 +645,126 @@ int main(int argc, char* argv[]) {
     cfg = parsed->fallback;
   }
 
-  if (cfg->data.input_path.empty()) {
-    std::cerr << "Input path is required via --config or --input\n";
+  if (parsed->threads) {
+    cfg->data.threads = *parsed->threads;
+  }
+  if (parsed->stream) {
+    cfg->data.stream = true;
+  }
+  if (parsed->no_cache) {
+    cfg->data.cache = false;
+  }
+  if (parsed->follow_state) {
+    cfg->data.follow_state = *parsed->follow_state;
+  }
+  if (parsed->from) {
+    cfg->data.range.from = *parsed->from;
+  }
+  if (parsed->to) {
+    cfg->data.range.to = *parsed->to;
+  }
+  if (parsed->resample) {
+    cfg->data.resample = *parsed->resample;
+  }
+  if (parsed->tick_bars) {
+    cfg->data.tick_bars = *parsed->tick_bars;
+  }
+  if (parsed->validate) {
+    cfg->data.validate = true;
+  }
+  if (parsed->by_symbol) {
+    cfg->data.by_symbol = true;
+  }
+  if (parsed->csv_index) {
+    cfg->data.csv_index = true;
+  }
+  if (parsed->dataset) {
+    cfg->data.dataset = *parsed->dataset;
+  }
+  if (parsed->symbols) {
+    cfg->data.symbols = *parsed->symbols;
+  }
+
+  if (cfg->data.inputs.empty() && cfg->data.dataset.empty()) {
+    std::cerr << "Input path is required via --config, --input or --dataset\n";
+    return 1;
+  }
+
+  if (cfg->data.validate &&
+      (cfg->data.stream || !cfg->data.follow_state.empty() || !cfg->data.tick_bars.empty())) {
+    std::cerr << "--validate needs candles loaded in batch mode\n";
+    return 1;
+  }
+  if (!lwti::Backtester(cfg->backtest).fixed_ledger_fits()) {
+    std::cerr << "Starting equity exceeds 2^53 units of --tick-size x --lot-size\n";
+    return 1;
+  }
+  const bool per_symbol = cfg->data.by_symbol || !cfg->data.dataset.empty();
+  if (per_symbol && (!cfg->data.follow_state.empty() || !cfg->data.tick_bars.empty())) {
+    std::cerr << "--by-symbol and --dataset do not combine with --follow or --tick-bars\n";
+    return 1;
+  }
+  if (cfg->data.by_symbol && cfg->data.stream) {
+    std::cerr << "--by-symbol needs candles loaded in batch mode\n";
     return 1;
   }
+  if (per_symbol && cfg->data.stream) {
+    return run_dataset_streaming(*cfg, *parsed);
+  }
+  if (per_symbol) {
+    return run_by_symbol(*cfg, *parsed);
+  }
+  if (!cfg->data.follow_state.empty()) {
+    return run_follow(*cfg, *parsed);
+  }
+  if (!cfg->data.tick_bars.empty()) {
+    return run_tick_bars(*cfg, *parsed);
+  }
 
-  const auto candles = lwti::read_candles_csv(cfg->data.input_path);
+  if (cfg->data.stream) {
+    auto source = lwti::open_candle_source(cfg->data);
+    const auto backtest =
+        source ? run_streaming(*cfg, *source, parsed->export_signals) : std::nullopt;
+    if (!backtest) {
+      std::cerr << "No candles loaded from " << describe_inputs(cfg->data) << "\n";
+      return 1;
+    }
+    write_report(*backtest, parsed->report_path);
+    print_summary(*backtest);
+    return 0;
+  }
+
+  lwti::ValidationReport quality;
+  auto candles = lwti::load_candles(cfg->data, &quality);
   if (candles.empty()) {
-    std::cerr << "No candles loaded from " << cfg->data.input_path << "\n";
+    std::cerr << "No candles loaded from " << describe_inputs(cfg->data) << "\n";
     return 1;
   }
+  if (cfg->data.validate) {
+    print_quality(quality);
+  }
 
-  const auto lwti_points =
-      lwti::LiquidityWeightedTrendIndicator(cfg->lwti).compute(candles);
-  const auto vwap_points = lwti::VwapBandIndicator(cfg->vwap).compute(candles);
-  const auto regime_points = lwti::VolatilityRegimeIndicator(cfg->regime).compute(candles);
-  const auto strat_points =
-      lwti::CompositeStrategy(cfg->strategy).generate(lwti_points, vwap_points, regime_points);
-  const auto backtest = lwti::Backtester(cfg->backtest).run(candles, strat_points);
+  if (parsed->write_dataset) {
+    // A single-symbol input is filed under the one symbol named.
+    if (cfg->data.symbols.size() != 1) {
+      std::cerr << "--write-dataset needs --by-symbol or a single --symbols name\n";
+      return 1;
+    }
+    return save_dataset(*parsed->write_dataset, {{cfg->data.symbols.front(), candles}},
+                         cfg->data.threads);
+  }
 
-  write_signals(candles, lwti_points, vwap_points, regime_points, strat_points,
-                parsed->export_signals);
-  write_report(backtest, parsed->report_path);
+  if (parsed->write_store) {
+    if (!lwti::write_candle_store(*parsed->write_store, candles)) {
+      std::cerr << "Failed to write store: " << *parsed->write_store << "\n";
+      return 1;
+    }
+    std::cout << "# Wrote " << candles.size() << " candles to " << *parsed->write_store << "\n";
+    return 0;
+  }
 
-  std::cout << "# Backtest ending equity: " << backtest.ending_equity
-            << " | trades=" << backtest.trades
-            << " | win_rate=" << backtest.win_rate * 100.0 << "%\n";
+  const lwti::CandleSeries series(std::move(candles));
+  print_summary(run_batch(*cfg, series, parsed->export_signals, parsed->report_path,
+                          cfg->data.validate ? &quality : nullptr));
   return 0;
 }
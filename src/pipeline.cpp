@@ -0,0 +1,44 @@
+#include "backtest/pipeline.hpp"
+
+#include "core/state_codec.hpp"
+
+namespace lwti {
+
+Pipeline::Pipeline(const RunConfig& config)
+    : lwti_(LiquidityWeightedTrendIndicator(config.lwti).stream()),
+      vwap_(VwapBandIndicator(config.vwap).stream()),
+      regime_(VolatilityRegimeIndicator(config.regime).stream()),
+      strategy_(config.strategy),
+      session_(Backtester(config.backtest).session()) {}
+
+PipelineStep Pipeline::update(const Candle& candle) {
+  PipelineStep step;
+  step.lwti = lwti_.update(candle);
+  step.vwap = vwap_.update(candle);
+  step.regime = regime_.update(candle);
+  step.strategy = strategy_.evaluate(step.lwti, step.vwap, step.regime);
+  ++bars_;
+  session_.update(candle, step.strategy);
+  return step;
+}
+
+void Pipeline::save(StateWriter& out) const {
+  const auto& strategy = strategy_.config();
+  out.put(strategy.lwti_weight);
+  out.put(strategy.vwap_weight);
+  out.put(strategy.max_position);
+  out.put(bars_);
+  lwti_.save(out);
+  vwap_.save(out);
+  regime_.save(out);
+  session_.save(out);
+}
+
+bool Pipeline::restore(StateReader& in) {
+  const auto& strategy = strategy_.config();
+  return in.expect(strategy.lwti_weight) && in.expect(strategy.vwap_weight) &&
+         in.expect(strategy.max_position) && in.get(bars_) && lwti_.restore(in) &&
+         vwap_.restore(in) && regime_.restore(in) && session_.restore(in);
+}
+
+}  // namespace lwti
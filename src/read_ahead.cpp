@@ -0,0 +1,365 @@
+#include "io/read_ahead.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define LWTI_HAS_IO_URING 1
+#endif
+
+namespace lwti {
+
+#ifdef LWTI_HAS_IO_URING
+
+// Minimal io_uring over the raw syscalls: one submission and one
+// completion ring, reads only.
+struct ReadAhead::Uring {
+  int fd{-1};
+  void* sq_ring{MAP_FAILED};
+  std::size_t sq_ring_bytes{0};
+  void* cq_ring{MAP_FAILED};
+  std::size_t cq_ring_bytes{0};
+  io_uring_sqe* sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+  std::size_t sqes_bytes{0};
+  unsigned* sq_tail{nullptr};
+  unsigned* sq_mask{nullptr};
+  unsigned* sq_array{nullptr};
+  unsigned* cq_head{nullptr};
+  unsigned* cq_tail{nullptr};
+  unsigned* cq_mask{nullptr};
+  io_uring_cqe* cqes{nullptr};
+
+  ~Uring() {
+    if (sqes != MAP_FAILED) ::munmap(sqes, sqes_bytes);
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) ::munmap(cq_ring, cq_ring_bytes);
+    if (sq_ring != MAP_FAILED) ::munmap(sq_ring, sq_ring_bytes);
+    if (fd >= 0) ::close(fd);
+  }
+
+  bool setup(unsigned entries) {
+    io_uring_params params{};
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      return false;  // no kernel support, or blocked by a sandbox
+    }
+    sq_ring_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+      sq_ring_bytes = cq_ring_bytes = std::max(sq_ring_bytes, cq_ring_bytes);
+    }
+    sq_ring = ::mmap(nullptr, sq_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) return false;
+    cq_ring = single ? sq_ring
+                     : ::mmap(nullptr, cq_ring_bytes, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) return false;
+    sqes_bytes = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqes_bytes, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED) return false;
+
+    auto* sq = static_cast<char*>(sq_ring);
+    auto* cq = static_cast<char*>(cq_ring);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void queue_read(int file, char* buffer, std::size_t bytes, std::uint64_t offset,
+                  std::uint64_t tag) {
+    const unsigned tail = *sq_tail;
+    const unsigned index = tail & *sq_mask;
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = file;
+    sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+    sqe.len = static_cast<std::uint32_t>(bytes);
+    sqe.off = offset;
+    sqe.user_data = tag;
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+  }
+
+  // Submits queued reads and waits for at least wait completions.
+  int enter(unsigned submit, unsigned wait) {
+    while (true) {
+      const long rc = ::syscall(__NR_io_uring_enter, fd, submit, wait,
+                                wait > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+      if (rc >= 0 || errno != EINTR) return static_cast<int>(rc);
+    }
+  }
+
+  bool pop(std::uint64_t& tag, int& result) {
+    const unsigned head = *cq_head;
+    if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) return false;
+    const io_uring_cqe& cqe = cqes[head & *cq_mask];
+    tag = cqe.user_data;
+    result = cqe.res;
+    __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+};
+
+#else
+
+struct ReadAhead::Uring {
+  bool setup(unsigned) { return false; }
+};
+
+#endif
+
+void ReadAhead::AlignedFree::operator()(char* p) const { std::free(p); }
+void ReadAhead::UringDelete::operator()(Uring* p) const { delete p; }
+
+ReadAhead::ReadAhead(const std::string& path, std::uint64_t start, Backend backend,
+                     std::size_t chunk_bytes, std::size_t depth) {
+  fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    return;
+  }
+  struct stat st {};
+  if (::fstat(fd_, &st) != 0) {
+    ::close(fd_);
+    fd_ = -1;
+    return;
+  }
+  size_ = static_cast<std::uint64_t>(st.st_size);
+  next_offset_ = std::min(start, size_);
+  ::posix_fadvise(fd_, static_cast<off_t>(next_offset_), 0, POSIX_FADV_SEQUENTIAL);
+
+  constexpr std::size_t kAlign = 4096;
+  chunk_bytes = (std::max(chunk_bytes, kAlign) + kAlign - 1) / kAlign * kAlign;
+  depth = std::max<std::size_t>(depth, 1);
+  memory_.reset(static_cast<char*>(std::aligned_alloc(kAlign, chunk_bytes * depth)));
+  if (!memory_) {
+    ::close(fd_);
+    fd_ = -1;
+    return;
+  }
+  ring_.resize(depth);
+  for (std::size_t i = 0; i < depth; ++i) {
+    ring_[i].data = memory_.get() + i * chunk_bytes;
+  }
+  chunk_bytes_ = chunk_bytes;
+
+  if (backend == Backend::kAuto) {
+    std::unique_ptr<Uring, UringDelete> uring(new Uring);
+    if (uring->setup(static_cast<unsigned>(depth))) {
+      uring_ = std::move(uring);
+    }
+  }
+  thread_ = std::thread([this] {
+    if (uring_) {
+      run_uring();
+    } else {
+      run_pread();
+    }
+  });
+}
+
+ReadAhead::~ReadAhead() {
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+  }
+  uring_.reset();
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+std::string_view ReadAhead::backend() const { return uring_ ? "io_uring" : "pread"; }
+
+bool ReadAhead::claim(std::size_t& index) {
+  Chunk& chunk = ring_[tail_];
+  if (stop_ || truncated_ || next_offset_ >= size_ || chunk.busy || chunk.ready) {
+    return false;
+  }
+  chunk.offset = next_offset_;
+  chunk.want =
+      static_cast<std::size_t>(std::min<std::uint64_t>(chunk_bytes_, size_ - next_offset_));
+  chunk.bytes = 0;
+  chunk.taken = 0;
+  chunk.busy = true;
+  next_offset_ += chunk.want;
+  index = tail_;
+  tail_ = (tail_ + 1) % ring_.size();
+  return true;
+}
+
+void ReadAhead::publish(std::size_t index) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Chunk& chunk = ring_[index];
+    chunk.busy = false;
+    chunk.ready = true;
+    if (chunk.bytes < chunk.want) {
+      truncated_ = true;  // the file shrank or failed; nothing after this
+    }
+  }
+  changed_.notify_all();
+}
+
+void ReadAhead::pread_fill(Chunk& chunk) {
+  while (chunk.bytes < chunk.want) {
+    const ssize_t n = ::pread(fd_, chunk.data + chunk.bytes, chunk.want - chunk.bytes,
+                              static_cast<off_t>(chunk.offset + chunk.bytes));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    chunk.bytes += static_cast<std::size_t>(n);
+  }
+}
+
+void ReadAhead::run_pread() {
+  while (true) {
+    std::size_t index = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      changed_.wait(lock, [&] {
+        const Chunk& next = ring_[tail_];
+        return stop_ || truncated_ || next_offset_ >= size_ || (!next.busy && !next.ready);
+      });
+      if (!claim(index)) {
+        return;
+      }
+    }
+    pread_fill(ring_[index]);
+    publish(index);
+  }
+}
+
+void ReadAhead::run_uring() {
+#ifdef LWTI_HAS_IO_URING
+  std::size_t inflight = 0;
+  bool broken = false;  // a submit failed; finish with pread
+  while (true) {
+    std::vector<std::size_t> queued;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (inflight == 0) {
+        changed_.wait(lock, [&] {
+          const Chunk& next = ring_[tail_];
+          return stop_ || truncated_ || next_offset_ >= size_ || (!next.busy && !next.ready);
+        });
+      }
+      std::size_t index = 0;
+      while (claim(index)) {
+        queued.push_back(index);
+      }
+      if (queued.empty() && inflight == 0) {
+        return;  // stopped or everything read
+      }
+    }
+    if (broken) {
+      for (const std::size_t index : queued) {
+        pread_fill(ring_[index]);
+        publish(index);
+      }
+    } else if (!queued.empty()) {
+      for (const std::size_t index : queued) {
+        const Chunk& chunk = ring_[index];
+        uring_->queue_read(fd_, chunk.data, chunk.want, chunk.offset, index);
+      }
+      if (uring_->enter(static_cast<unsigned>(queued.size()), 0) < 0) {
+        broken = true;
+        for (const std::size_t index : queued) {
+          pread_fill(ring_[index]);
+          publish(index);
+        }
+      } else {
+        inflight += queued.size();
+      }
+    }
+    if (inflight == 0) {
+      continue;
+    }
+    if (uring_->enter(0, 1) < 0) {
+      std::this_thread::yield();  // completions are still polled below
+    }
+
+    std::uint64_t tag = 0;
+    int result = 0;
+    std::vector<std::size_t> resubmitted;
+    while (uring_->pop(tag, result)) {
+      Chunk& chunk = ring_[tag];
+      if (result < 0) {
+        pread_fill(chunk);  // e.g. an older kernel without IORING_OP_READ
+      } else if (result > 0) {
+        chunk.bytes += static_cast<std::size_t>(result);
+        if (chunk.bytes < chunk.want) {
+          uring_->queue_read(fd_, chunk.data + chunk.bytes, chunk.want - chunk.bytes,
+                             chunk.offset + chunk.bytes, tag);
+          resubmitted.push_back(tag);
+          continue;
+        }
+      }
+      --inflight;
+      publish(tag);
+    }
+    if (!resubmitted.empty() &&
+        uring_->enter(static_cast<unsigned>(resubmitted.size()), 0) < 0) {
+      broken = true;
+      for (const std::size_t index : resubmitted) {
+        pread_fill(ring_[index]);
+        --inflight;
+        publish(index);
+      }
+    }
+  }
+#endif
+}
+
+std::size_t ReadAhead::read(char* out, std::size_t size) {
+  std::size_t copied = 0;
+  while (copied < size && !done_) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Chunk& chunk = ring_[head_];
+    changed_.wait(lock, [&] {
+      return chunk.ready || (!chunk.busy && (truncated_ || next_offset_ >= size_));
+    });
+    if (!chunk.ready) {
+      done_ = true;
+      break;
+    }
+    lock.unlock();
+
+    const std::size_t n = std::min(size - copied, chunk.bytes - chunk.taken);
+    std::memcpy(out + copied, chunk.data + chunk.taken, n);
+    chunk.taken += n;
+    copied += n;
+    if (chunk.taken == chunk.bytes) {
+      lock.lock();
+      chunk.ready = false;
+      if (chunk.bytes < chunk.want) {
+        done_ = true;
+      }
+      head_ = (head_ + 1) % ring_.size();
+      lock.unlock();
+      changed_.notify_all();
+    }
+  }
+  return copied;
+}
+
+}  // namespace lwti
@@ -2,7 +2,8 @@
 
 #include <algorithm>
 #include <cmath>
-#include <deque>
+
+#include "core/state_codec.hpp"
 
 namespace lwti {
 namespace {
@@ -11,55 +12,97 @@ std::size_t clamp_period(std::size_t value) { return std::max<std::size_t>(1, va
 
 }  // namespace
 
-VolatilityRegimeIndicator::VolatilityRegimeIndicator(RegimeConfig config) : config_(config) {
+template <typename Scalar>
+BasicVolatilityRegimeIndicator<Scalar>::BasicVolatilityRegimeIndicator(RegimeConfig config)
+    : config_(config) {
   config_.window = clamp_period(config_.window);
   config_.high_vol_threshold = std::max(0.0, config_.high_vol_threshold);
 }
 
-std::vector<RegimePoint> VolatilityRegimeIndicator::compute(
-    const std::vector<Candle>& candles) const {
-  if (candles.empty()) return {};
+template <typename Scalar>
+auto BasicVolatilityRegimeIndicator<Scalar>::compute(const std::vector<Candle>& candles) const
+    -> std::vector<Point> {
+  std::vector<Point> out;
+  out.reserve(candles.size());
+  Stream state = stream();
+  for (const auto& c : candles) {
+    out.push_back(state.update(c));
+  }
+  return out;
+}
 
-  std::deque<double> returns;
-  double sum = 0.0;
-  double sq_sum = 0.0;
+template <typename Scalar>
+auto BasicVolatilityRegimeIndicator<Scalar>::compute(const CandleSeries& series) const
+    -> std::vector<Point> {
+  std::vector<Point> out(series.size());
+  compute(series.close, out);
+  return out;
+}
 
-  std::vector<RegimePoint> out;
-  out.reserve(candles.size());
+template <typename Scalar>
+std::size_t BasicVolatilityRegimeIndicator<Scalar>::compute(std::span<const double> close,
+                                                            std::span<Point> out) const {
+  const std::size_t n = std::min(close.size(), out.size());
+  Stream state = stream();
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = state.update(close[i]);
+  }
+  return n;
+}
 
-  double prev_close = candles.front().close;
-  for (std::size_t i = 0; i < candles.size(); ++i) {
-    const auto& c = candles[i];
-    if (i > 0) {
-      const double ret = (c.close - prev_close) / prev_close;
-      returns.push_back(ret);
-      sum += ret;
-      sq_sum += ret * ret;
-      if (returns.size() > config_.window) {
-        const double removed = returns.front();
-        returns.pop_front();
-        sum -= removed;
-        sq_sum -= removed * removed;
-      }
-      prev_close = c.close;
-    }
+template <typename Scalar>
+auto BasicVolatilityRegimeIndicator<Scalar>::Stream::update(const Candle& c) -> Point {
+  return update(c.close);
+}
 
-    double variance = 0.0;
-    if (!returns.empty()) {
-      const double mean = sum / static_cast<double>(returns.size());
-      variance = sq_sum / static_cast<double>(returns.size()) - mean * mean;
-      if (variance < 0.0) variance = 0.0;
+template <typename Scalar>
+auto BasicVolatilityRegimeIndicator<Scalar>::Stream::update(double close) -> Point {
+  const std::size_t i = index_++;
+  const Scalar price = static_cast<Scalar>(close);
+  if (i > 0) {
+    // A zero close (bad print) would turn every later variance into NaN.
+    const Scalar ret =
+        std::abs(prev_close_) > Scalar(1e-9) ? (price - prev_close_) / prev_close_ : Scalar{0};
+    returns_.push_back(ret);
+    if (returns_.size() > config_.window) {
+      moments_.replace(returns_.front(), ret, config_.window);
+      returns_.pop_front();
+    } else {
+      moments_.push(ret, returns_.size());
     }
-    const double vol = std::sqrt(variance);
+  }
+  prev_close_ = price;
 
-    VolatilityRegime regime = vol > config_.high_vol_threshold ? VolatilityRegime::High
-                                                               : VolatilityRegime::Low;
-    Signal signal = regime == VolatilityRegime::High ? Signal::Flat : Signal::Long;
+  const Scalar vol = std::sqrt(moments_.variance(returns_.size()));
+  VolatilityRegime regime = vol > static_cast<Scalar>(config_.high_vol_threshold)
+                                ? VolatilityRegime::High
+                                : VolatilityRegime::Low;
+  Signal signal = regime == VolatilityRegime::High ? Signal::Flat : Signal::Long;
 
-    out.push_back({i, c.timestamp, vol, regime, signal});
-  }
+  return {vol, regime, signal};
+}
 
-  return out;
+template <typename Scalar>
+void BasicVolatilityRegimeIndicator<Scalar>::Stream::save(StateWriter& out) const {
+  out.put(config_.window);
+  out.put(config_.high_vol_threshold);
+  out.put(index_);
+  out.put(returns_);
+  out.put(moments_.mean.sum);
+  out.put(moments_.mean.carry);
+  out.put(moments_.m2.sum);
+  out.put(moments_.m2.carry);
+  out.put(prev_close_);
+}
+
+template <typename Scalar>
+bool BasicVolatilityRegimeIndicator<Scalar>::Stream::restore(StateReader& in) {
+  return in.expect(config_.window) && in.expect(config_.high_vol_threshold) && in.get(index_) &&
+         in.get(returns_) && in.get(moments_.mean.sum) && in.get(moments_.mean.carry) &&
+         in.get(moments_.m2.sum) && in.get(moments_.m2.carry) && in.get(prev_close_);
 }
 
+template class BasicVolatilityRegimeIndicator<float>;
+template class BasicVolatilityRegimeIndicator<double>;
+
 }  // namespace lwti
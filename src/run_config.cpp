@@ -2,7 +2,9 @@
 
 #include <fstream>
 #include <iostream>
+#include <utility>
 
+#include "core/time.hpp"
 #include "nlohmann/json.hpp"
 
 namespace lwti {
@@ -37,7 +39,55 @@ std::optional<RunConfig> load_run_config(const std::string& path) {
 
   if (j.contains("data")) {
     const auto& jd = j["data"];
-    set_if_exists(jd, "input_path", cfg.data.input_path);
+    // A single path, glob or directory, or a list of them.
+    if (jd.contains("input_path")) {
+      const auto& ji = jd.at("input_path");
+      if (ji.is_array()) {
+        cfg.data.inputs = ji.get<std::vector<std::string>>();
+      } else {
+        cfg.data.inputs = {ji.get<std::string>()};
+      }
+    }
+    set_if_exists(jd, "threads", cfg.data.threads);
+    set_if_exists(jd, "stream", cfg.data.stream);
+    set_if_exists(jd, "cache", cfg.data.cache);
+    set_if_exists(jd, "csv_index", cfg.data.csv_index);
+    set_if_exists(jd, "follow_state", cfg.data.follow_state);
+    set_if_exists(jd, "validate", cfg.data.validate);
+    set_if_exists(jd, "by_symbol", cfg.data.by_symbol);
+    set_if_exists(jd, "dataset", cfg.data.dataset);
+    if (jd.contains("symbols")) {
+      const auto& js = jd.at("symbols");
+      if (js.is_array()) {
+        cfg.data.symbols = js.get<std::vector<std::string>>();
+      } else {
+        cfg.data.symbols = {js.get<std::string>()};
+      }
+    }
+    for (const auto& [key, bound] : {std::pair{"from", &cfg.data.range.from},
+                                     std::pair{"to", &cfg.data.range.to}}) {
+      if (!jd.contains(key)) continue;
+      const auto text = jd.at(key).get<std::string>();
+      if (!parse_timestamp(text, *bound)) {
+        std::cerr << "Invalid data." << key << ": " << text << "\n";
+        return std::nullopt;
+      }
+    }
+    if (jd.contains("resample")) {
+      const auto period = jd.at("resample").get<std::string>();
+      if (!parse_duration(period, cfg.data.resample)) {
+        std::cerr << "Invalid data.resample: " << period << "\n";
+        return std::nullopt;
+      }
+    }
+    if (jd.contains("tick_bars")) {
+      const auto& jt = jd.at("tick_bars");
+      if (jt.is_array()) {
+        cfg.data.tick_bars = jt.get<std::vector<std::string>>();
+      } else {
+        cfg.data.tick_bars = {jt.get<std::string>()};
+      }
+    }
   }
 
   if (j.contains("lwti")) {
@@ -74,6 +124,8 @@ std::optional<RunConfig> load_run_config(const std::string& path) {
     set_if_exists(jb, "risk_per_trade", cfg.backtest.risk_per_trade);
     set_if_exists(jb, "fee_bps", cfg.backtest.fee_bps);
     set_if_exists(jb, "slippage_bps", cfg.backtest.slippage_bps);
+    set_if_exists(jb, "tick_size", cfg.backtest.tick_size);
+    set_if_exists(jb, "lot_size", cfg.backtest.lot_size);
   }
 
   return cfg;
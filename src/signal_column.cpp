@@ -0,0 +1,125 @@
+#include "core/signal_column.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace lwti {
+namespace {
+
+constexpr std::uint64_t kLowBits = 0x5555555555555555ULL;  // bit 0 of every slot
+
+// Slot mask of the bars word w holds in a column of size bars.
+std::uint64_t used_slots(std::size_t w, std::size_t size) {
+  const std::size_t bars = size - w * SignalColumn::kBarsPerWord;
+  return bars >= SignalColumn::kBarsPerWord ? kLowBits : kLowBits & ((1ULL << (2 * bars)) - 1);
+}
+
+// Low bit set in each slot whose code differs from the previous bar's.
+std::uint64_t changed_slots(std::uint64_t word, std::uint64_t previous_code) {
+  const std::uint64_t diff = word ^ ((word << 2) | previous_code);
+  return (diff | (diff >> 1)) & kLowBits;
+}
+
+}  // namespace
+
+std::uint64_t signal_code(Signal signal) {
+  switch (signal) {
+    case Signal::Long:
+      return 1;
+    case Signal::Short:
+      return 2;
+    case Signal::Flat:
+    default:
+      return 0;
+  }
+}
+
+Signal signal_from_code(std::uint64_t code) {
+  return code == 1 ? Signal::Long : code == 2 ? Signal::Short : Signal::Flat;
+}
+
+SignalColumn::SignalColumn(std::size_t size)
+    : words_((size + kBarsPerWord - 1) / kBarsPerWord, 0), size_(size) {}
+
+SignalColumn SignalColumn::from_words(std::vector<std::uint64_t> words, std::size_t size) {
+  SignalColumn column;
+  column.words_ = std::move(words);
+  column.words_.resize((size + kBarsPerWord - 1) / kBarsPerWord, 0);
+  column.size_ = size;
+  if (size % kBarsPerWord != 0) {
+    column.words_.back() &= (1ULL << (2 * (size % kBarsPerWord))) - 1;
+  }
+  for (std::uint64_t& word : column.words_) {
+    word &= ~((word & (word >> 1) & kLowBits) * 3);  // unused code 3 -> flat
+  }
+  return column;
+}
+
+Signal SignalColumn::operator[](std::size_t i) const {
+  return signal_from_code((words_[i / kBarsPerWord] >> (2 * (i % kBarsPerWord))) & 3);
+}
+
+void SignalColumn::set(std::size_t i, Signal signal) {
+  const unsigned shift = 2 * (i % kBarsPerWord);
+  std::uint64_t& word = words_[i / kBarsPerWord];
+  word = (word & ~(3ULL << shift)) | (signal_code(signal) << shift);
+}
+
+void SignalColumn::push_back(Signal signal) {
+  if (size_ % kBarsPerWord == 0) words_.push_back(0);
+  set(size_++, signal);
+}
+
+std::vector<std::int8_t> SignalColumn::polarity() const {
+  std::vector<std::int8_t> out(size_);
+  for (std::size_t w = 0; w < words_.size(); ++w) {
+    const std::uint64_t word = words_[w];
+    const std::size_t first = w * kBarsPerWord;
+    const std::size_t bars = std::min(kBarsPerWord, size_ - first);
+    for (std::size_t j = 0; j < bars; ++j) {
+      const int code = static_cast<int>((word >> (2 * j)) & 3);
+      out[first + j] = static_cast<std::int8_t>((code & 1) - (code >> 1));
+    }
+  }
+  return out;
+}
+
+SignalCounts SignalColumn::counts() const {
+  SignalCounts counts;
+  for (const std::uint64_t word : words_) {
+    counts.long_bars += static_cast<std::size_t>(std::popcount(word & kLowBits));
+    counts.short_bars += static_cast<std::size_t>(std::popcount((word >> 1) & kLowBits));
+  }
+  counts.flat_bars = size_ - counts.long_bars - counts.short_bars;
+  return counts;
+}
+
+std::size_t SignalColumn::transitions() const {
+  std::size_t count = 0;
+  std::uint64_t previous = words_.empty() ? 0 : words_[0] & 3;
+  for (std::size_t w = 0; w < words_.size(); ++w) {
+    const std::uint64_t word = words_[w];
+    count += static_cast<std::size_t>(
+        std::popcount(changed_slots(word, previous) & used_slots(w, size_)));
+    previous = word >> 62;
+  }
+  return count;
+}
+
+std::vector<std::size_t> SignalColumn::transition_bars() const {
+  std::vector<std::size_t> bars;
+  std::uint64_t previous = words_.empty() ? 0 : words_[0] & 3;
+  for (std::size_t w = 0; w < words_.size(); ++w) {
+    const std::uint64_t word = words_[w];
+    std::uint64_t changed = changed_slots(word, previous) & used_slots(w, size_);
+    while (changed != 0) {
+      bars.push_back(w * kBarsPerWord + static_cast<std::size_t>(std::countr_zero(changed)) / 2);
+      changed &= changed - 1;
+    }
+    previous = word >> 62;
+  }
+  return bars;
+}
+
+}  // namespace lwti
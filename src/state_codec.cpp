@@ -0,0 +1,78 @@
+#include "core/state_codec.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "core/temp_path.hpp"
+
+namespace lwti {
+
+namespace {
+
+template <typename T>
+void put_deque(StateWriter& out, const std::deque<T>& values) {
+  out.put(static_cast<std::uint64_t>(values.size()));
+  for (const T v : values) {
+    out.put(v);
+  }
+}
+
+template <typename T>
+bool get_deque(StateReader& in, std::size_t remaining, std::deque<T>& values) {
+  std::uint64_t count = 0;
+  if (!in.get(count) || count > (remaining - sizeof(count)) / sizeof(T)) {
+    return false;
+  }
+  values.clear();
+  for (std::uint64_t i = 0; i < count; ++i) {
+    T v{};
+    in.get(v);
+    values.push_back(v);
+  }
+  return true;
+}
+
+}  // namespace
+
+void StateWriter::put(const std::deque<double>& values) { put_deque(*this, values); }
+void StateWriter::put(const std::deque<float>& values) { put_deque(*this, values); }
+
+bool StateReader::get(std::deque<double>& values) {
+  return get_deque(*this, bytes_.size(), values);
+}
+bool StateReader::get(std::deque<float>& values) {
+  return get_deque(*this, bytes_.size(), values);
+}
+
+std::optional<std::string> read_state_file(const std::string& path) {
+  std::ifstream input(path, std::ios::binary);
+  if (!input.is_open()) {
+    return std::nullopt;
+  }
+  return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+bool write_state_file(const std::string& path, const std::string& bytes) {
+  const std::string tmp_path = temp_path_for(path);
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+      out.close();
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace lwti
@@ -0,0 +1,82 @@
+#include "io/structural_scanner.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LWTI_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace lwti {
+namespace {
+
+[[maybe_unused]] StructuralMasks scan_scalar(const char* block) {
+  StructuralMasks masks;
+  for (std::size_t i = 0; i < kScanBlock; ++i) {
+    masks.comma |= static_cast<std::uint64_t>(block[i] == ',') << i;
+    masks.newline |= static_cast<std::uint64_t>(block[i] == '\n') << i;
+  }
+  return masks;
+}
+
+#ifdef LWTI_SCANNER_X86
+
+__attribute__((target("avx2"))) std::uint64_t match_avx2(__m256i lo, __m256i hi,
+                                                        char needle) {
+  const __m256i n = _mm256_set1_epi8(needle);
+  const auto low = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, n)));
+  const auto high = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, n)));
+  return static_cast<std::uint64_t>(low) | (static_cast<std::uint64_t>(high) << 32);
+}
+
+__attribute__((target("avx2"))) StructuralMasks scan_avx2(const char* block) {
+  const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+  const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+  return {match_avx2(lo, hi, ','), match_avx2(lo, hi, '\n')};
+}
+
+StructuralMasks scan_sse2(const char* block) {
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i newline = _mm_set1_epi8('\n');
+  StructuralMasks masks;
+  for (std::size_t i = 0; i < kScanBlock; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+    masks.comma |= static_cast<std::uint64_t>(
+                       static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma))))
+                   << i;
+    masks.newline |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(
+                         _mm_movemask_epi8(_mm_cmpeq_epi8(v, newline))))
+                     << i;
+  }
+  return masks;
+}
+
+#endif
+
+struct Backend {
+  BlockScanner scan;
+  std::string_view name;
+};
+
+Backend select_backend() {
+#ifdef LWTI_SCANNER_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {scan_avx2, "avx2"};
+  }
+  return {scan_sse2, "sse2"};
+#else
+  return {scan_scalar, "scalar"};
+#endif
+}
+
+const Backend& backend() {
+  static const Backend selected = select_backend();
+  return selected;
+}
+
+}  // namespace
+
+BlockScanner block_scanner() { return backend().scan; }
+
+std::string_view scanner_backend() { return backend().name; }
+
+}  // namespace lwti
@@ -0,0 +1,129 @@
+#include "io/tick_reader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+#include "core/time.hpp"
+#include "io/field_parse.hpp"
+#include "io/mapped_file.hpp"
+
+namespace lwti {
+namespace {
+
+int field_of(std::string name) {
+  std::transform(name.begin(), name.end(), name.begin(),
+                 [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+  if (name == "timestamp" || name == "time" || name == "ts") return 0;
+  if (name == "price" || name == "px" || name == "last") return 1;
+  if (name == "size" || name == "qty" || name == "volume" || name == "amount") return 2;
+  return -1;
+}
+
+}  // namespace
+
+const char* TickParser::resolve_header(const char* begin, const char* end) {
+  const char* cursor = begin;
+  while (cursor < end) {
+    const void* nl = std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor));
+    const char* line_end = nl != nullptr ? static_cast<const char*>(nl) : end;
+    const auto length = static_cast<std::size_t>(line_end - cursor);
+    std::string_view line = trim(std::string_view(cursor, length));
+    const char* next = line_end == end ? end : line_end + 1;
+    if (line.empty()) {
+      cursor = next;
+      continue;
+    }
+    resolved_ = true;
+
+    std::array<std::size_t, kFieldCount> columns;
+    columns.fill(kMaxMappedColumns);
+    for (std::size_t column = 0; column < kMaxMappedColumns; ++column) {
+      const std::size_t comma = line.find(',');
+      const int field = field_of(std::string(trim(line.substr(0, comma))));
+      if (field >= 0 && columns[static_cast<std::size_t>(field)] == kMaxMappedColumns) {
+        columns[static_cast<std::size_t>(field)] = column;
+      }
+      if (comma == std::string_view::npos) break;
+      line.remove_prefix(comma + 1);
+    }
+    if (std::find(columns.begin(), columns.end(), kMaxMappedColumns) != columns.end()) {
+      return cursor;  // no usable header: the line is data
+    }
+    slots_.fill(kSkipColumn);
+    min_fields_ = 0;
+    for (std::size_t f = 0; f < kFieldCount; ++f) {
+      slots_[columns[f]] = static_cast<std::uint8_t>(f);
+      min_fields_ = std::max(min_fields_, columns[f] + 1);
+    }
+    return next;
+  }
+  return end;
+}
+
+bool TickParser::parse_row(const std::array<std::string_view, kFieldCount>& fields, Tick& tick) {
+  return parse_timestamp(trim(fields[kTimestamp]), tick.timestamp) &&
+         parse_double(trim(fields[kPrice]), tick.price) &&
+         parse_double(trim(fields[kSize]), tick.size);
+}
+
+std::vector<std::vector<Candle>> aggregate_tick_files(const std::vector<std::string>& paths,
+                                                      const std::vector<Timestamp>& intervals) {
+  std::vector<BarAggregator> aggregators(intervals.begin(), intervals.end());
+  std::vector<std::vector<Candle>> bars(intervals.size());
+  Candle completed;
+  for (const auto& path : paths) {
+    const MappedFile file(path);
+    if (!file.is_open()) {
+      continue;
+    }
+    TickParser parser;
+    parser.parse(file.data(), file.data() + file.size(), [&](const Tick& tick) {
+      for (std::size_t k = 0; k < aggregators.size(); ++k) {
+        if (aggregators[k].add(tick, completed)) {
+          bars[k].push_back(completed);
+        }
+      }
+    });
+  }
+  for (std::size_t k = 0; k < aggregators.size(); ++k) {
+    if (aggregators[k].flush(completed)) {
+      bars[k].push_back(completed);
+    }
+  }
+  return bars;
+}
+
+TickBarSource::TickBarSource(std::vector<std::string> paths, Timestamp interval,
+                             std::size_t buffer_bytes)
+    : paths_(std::move(paths)), buffer_bytes_(buffer_bytes), aggregator_(interval) {}
+
+bool TickBarSource::next(std::vector<Candle>& batch) {
+  batch.clear();
+  Candle completed;
+  const char* begin = nullptr;
+  const char* end = nullptr;
+  while (batch.empty()) {
+    if (!reader_ || !reader_->next(begin, end)) {
+      if (next_path_ == paths_.size()) {
+        if (!flushed_ && aggregator_.flush(completed)) {
+          batch.push_back(completed);
+        }
+        flushed_ = true;
+        return !batch.empty();
+      }
+      reader_ = std::make_unique<LineReader>(paths_[next_path_++], buffer_bytes_);
+      parser_ = TickParser{};
+      continue;
+    }
+    parser_.parse(begin, end, [&](const Tick& tick) {
+      if (aggregator_.add(tick, completed)) {
+        batch.push_back(completed);
+      }
+    });
+  }
+  return true;
+}
+
+}  // namespace lwti
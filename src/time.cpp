@@ -0,0 +1,254 @@
+#include "core/time.hpp"
+
+#include <cstdint>
+#include <limits>
+
+namespace lwti {
+namespace {
+
+constexpr Timestamp kNanosPerMinute = 60 * kNanosPerSecond;
+constexpr Timestamp kNanosPerDay = 86400 * kNanosPerSecond;
+// int64 nanoseconds cover 1677-09-21 .. 2262-04-11; stay inside whole years.
+constexpr int kMinYear = 1678;
+constexpr int kMaxYear = 2261;
+
+bool is_digit(char ch) { return ch >= '0' && ch <= '9'; }
+
+int digits2(const char* p) { return (p[0] - '0') * 10 + (p[1] - '0'); }
+
+int digits4(const char* p) { return digits2(p) * 100 + digits2(p + 2); }
+
+bool is_leap(int y) { return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0; }
+
+int days_in_month(int y, int m) {
+  static constexpr int kDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  return m == 2 && is_leap(y) ? 29 : kDays[m - 1];
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant).
+std::int64_t days_from_civil(int y, int m, int d) {
+  y -= m <= 2;
+  const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = (153 * static_cast<unsigned>(m + (m > 2 ? -3 : 9)) + 2) / 5 +
+                       static_cast<unsigned>(d) - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+void civil_from_days(std::int64_t z, int& y, int& m, int& d) {
+  z += 719468;
+  const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(z - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+  m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+  y = static_cast<int>(static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2));
+}
+
+bool valid_date(int y, int m, int d) {
+  return y >= kMinYear && y <= kMaxYear && m >= 1 && m <= 12 && d >= 1 &&
+         d <= days_in_month(y, m);
+}
+
+Timestamp compose(int y, int mo, int d, int h, int mi, int s) {
+  return (days_from_civil(y, mo, d) * 86400 + h * 3600 + mi * 60 + s) * kNanosPerSecond;
+}
+
+// "YYYY-MM-DDTHH:MM:SSZ", the layout recorders emit.
+bool parse_fixed(std::string_view text, Timestamp& out) {
+  const char* p = text.data();
+  if (p[4] != '-' || p[7] != '-' || p[10] != 'T' || p[13] != ':' || p[16] != ':' ||
+      p[19] != 'Z') {
+    return false;
+  }
+  static constexpr int kDigitPos[14] = {0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18};
+  bool digits = true;
+  for (int pos : kDigitPos) {
+    digits &= is_digit(p[pos]);
+  }
+  if (!digits) return false;
+  const int y = digits4(p), mo = digits2(p + 5), d = digits2(p + 8);
+  const int h = digits2(p + 11), mi = digits2(p + 14), s = digits2(p + 17);
+  if (!valid_date(y, mo, d) || h > 23 || mi > 59 || s > 59) return false;
+  out = compose(y, mo, d, h, mi, s);
+  return true;
+}
+
+bool take_digits2(std::string_view& text, int& value) {
+  if (text.size() < 2 || !is_digit(text[0]) || !is_digit(text[1])) return false;
+  value = digits2(text.data());
+  text.remove_prefix(2);
+  return true;
+}
+
+bool take_char(std::string_view& text, char ch) {
+  if (text.empty() || text.front() != ch) return false;
+  text.remove_prefix(1);
+  return true;
+}
+
+bool parse_general(std::string_view text, Timestamp& out) {
+  if (text.size() < 10 || !is_digit(text[0]) || !is_digit(text[1]) || !is_digit(text[2]) ||
+      !is_digit(text[3])) {
+    return false;
+  }
+  const int y = digits4(text.data());
+  text.remove_prefix(4);
+  int mo = 0, d = 0;
+  if (!take_char(text, '-') || !take_digits2(text, mo) || !take_char(text, '-') ||
+      !take_digits2(text, d) || !valid_date(y, mo, d)) {
+    return false;
+  }
+
+  int h = 0, mi = 0, s = 0;
+  Timestamp fraction = 0;
+  if (!text.empty() && (text.front() == 'T' || text.front() == ' ')) {
+    text.remove_prefix(1);
+    if (!take_digits2(text, h) || !take_char(text, ':') || !take_digits2(text, mi)) {
+      return false;
+    }
+    if (take_char(text, ':') && !take_digits2(text, s)) {
+      return false;
+    }
+    if (!text.empty() && (text.front() == '.' || text.front() == ',')) {
+      text.remove_prefix(1);
+      Timestamp scale = kNanosPerSecond;
+      std::size_t count = 0;
+      while (!text.empty() && is_digit(text.front())) {
+        if (scale > 1) {
+          scale /= 10;
+          fraction += (text.front() - '0') * scale;
+        }
+        text.remove_prefix(1);
+        ++count;
+      }
+      if (count == 0) return false;
+    }
+    if (h > 23 || mi > 59 || s > 59) return false;
+  }
+
+  Timestamp offset = 0;
+  if (!text.empty() && text.front() == 'Z') {
+    text.remove_prefix(1);
+  } else if (!text.empty() && (text.front() == '+' || text.front() == '-')) {
+    const int sign = text.front() == '-' ? -1 : 1;
+    text.remove_prefix(1);
+    int oh = 0, om = 0;
+    if (!take_digits2(text, oh)) return false;
+    const bool colon = take_char(text, ':');
+    if (!take_digits2(text, om) && colon) return false;
+    if (oh > 23 || om > 59) return false;
+    offset = sign * (oh * 60 + om) * kNanosPerMinute;
+  }
+  if (!text.empty()) return false;
+
+  out = compose(y, mo, d, h, mi, s) + fraction - offset;
+  return true;
+}
+
+char* write_digits(char* out, unsigned value, int width) {
+  for (int i = width - 1; i >= 0; --i) {
+    out[i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return out + width;
+}
+
+}  // namespace
+
+bool parse_timestamp(std::string_view text, Timestamp& out) {
+  if (text.size() == 20 && parse_fixed(text, out)) {
+    return true;
+  }
+  return parse_general(text, out);
+}
+
+bool parse_duration(std::string_view text, Timestamp& out) {
+  struct Unit {
+    std::string_view suffix;
+    Timestamp nanos;
+  };
+  static constexpr Unit kUnits[] = {{"ns", 1},
+                                    {"us", 1'000},
+                                    {"ms", 1'000'000},
+                                    {"s", kNanosPerSecond},
+                                    {"m", kNanosPerMinute},
+                                    {"h", 60 * kNanosPerMinute},
+                                    {"d", kNanosPerDay}};
+  std::size_t digits = 0;
+  Timestamp count = 0;
+  while (digits < text.size() && is_digit(text[digits])) {
+    count = count * 10 + (text[digits] - '0');
+    if (++digits > 12) return false;
+  }
+  if (digits == 0 || count == 0) return false;
+  const std::string_view suffix = text.substr(digits);
+  for (const Unit& unit : kUnits) {
+    if (suffix == unit.suffix) {
+      if (count > std::numeric_limits<Timestamp>::max() / unit.nanos) return false;
+      out = count * unit.nanos;
+      return true;
+    }
+  }
+  return false;
+}
+
+CivilMonth month_of(Timestamp ts) {
+  std::int64_t days = ts / kNanosPerDay;
+  if (ts % kNanosPerDay < 0) --days;
+  int y = 0, m = 0, d = 0;
+  civil_from_days(days, y, m, d);
+  return {y, m};
+}
+
+std::size_t format_timestamp(Timestamp ts, char* out) {
+  std::int64_t days = ts / kNanosPerDay;
+  Timestamp rem = ts % kNanosPerDay;
+  if (rem < 0) {
+    rem += kNanosPerDay;
+    --days;
+  }
+  int y = 0, m = 0, d = 0;
+  civil_from_days(days, y, m, d);
+  const auto secs = static_cast<unsigned>(rem / kNanosPerSecond);
+  const auto nanos = static_cast<unsigned>(rem % kNanosPerSecond);
+
+  char* p = out;
+  if (y < 0) {
+    *p++ = '-';
+    y = -y;
+  }
+  p = write_digits(p, static_cast<unsigned>(y), 4);
+  *p++ = '-';
+  p = write_digits(p, static_cast<unsigned>(m), 2);
+  *p++ = '-';
+  p = write_digits(p, static_cast<unsigned>(d), 2);
+  *p++ = 'T';
+  p = write_digits(p, secs / 3600, 2);
+  *p++ = ':';
+  p = write_digits(p, secs / 60 % 60, 2);
+  *p++ = ':';
+  p = write_digits(p, secs % 60, 2);
+  if (nanos != 0) {
+    *p++ = '.';
+    if (nanos % 1'000'000 == 0) {
+      p = write_digits(p, nanos / 1'000'000, 3);
+    } else if (nanos % 1'000 == 0) {
+      p = write_digits(p, nanos / 1'000, 6);
+    } else {
+      p = write_digits(p, nanos, 9);
+    }
+  }
+  *p++ = 'Z';
+  return static_cast<std::size_t>(p - out);
+}
+
+std::string format_timestamp(Timestamp ts) {
+  char buf[kMaxTimestampChars];
+  return std::string(buf, format_timestamp(ts, buf));
+}
+
+}  // namespace lwti
@@ -2,7 +2,8 @@
 
 #include <algorithm>
 #include <cmath>
-#include <deque>
+
+#include "core/state_codec.hpp"
 
 namespace lwti {
 namespace {
@@ -11,71 +12,116 @@ std::size_t clamp_period(std::size_t value) { return std::max<std::size_t>(1, va
 
 }  // namespace
 
-VwapBandIndicator::VwapBandIndicator(VwapBandConfig config) : config_(config) {
+template <typename Scalar>
+BasicVwapBandIndicator<Scalar>::BasicVwapBandIndicator(VwapBandConfig config) : config_(config) {
   config_.window = clamp_period(config_.window);
   config_.band_deviation = std::max(0.1, config_.band_deviation);
 }
 
-std::vector<VwapBandPoint> VwapBandIndicator::compute(const std::vector<Candle>& candles) const {
-  if (candles.empty()) return {};
+template <typename Scalar>
+auto BasicVwapBandIndicator<Scalar>::compute(const std::vector<Candle>& candles) const
+    -> std::vector<Point> {
+  std::vector<Point> out;
+  out.reserve(candles.size());
+  Stream state = stream();
+  for (const auto& c : candles) {
+    out.push_back(state.update(c));
+  }
+  return out;
+}
 
-  std::deque<double> pv_window;
-  std::deque<double> v_window;
-  std::deque<double> price_window;
+template <typename Scalar>
+auto BasicVwapBandIndicator<Scalar>::compute(const CandleSeries& series) const
+    -> std::vector<Point> {
+  std::vector<Point> out(series.size());
+  compute(series.close, series.volume, out);
+  return out;
+}
 
-  double pv_sum = 0.0;
-  double v_sum = 0.0;
-  double price_sum = 0.0;
-  double price_sq_sum = 0.0;
+template <typename Scalar>
+std::size_t BasicVwapBandIndicator<Scalar>::compute(std::span<const double> close,
+                                                    std::span<const double> volume,
+                                                    std::span<Point> out) const {
+  const std::size_t n = std::min({close.size(), volume.size(), out.size()});
+  Stream state = stream();
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = state.update(close[i], volume[i]);
+  }
+  return n;
+}
 
-  std::vector<VwapBandPoint> out;
-  out.reserve(candles.size());
+template <typename Scalar>
+auto BasicVwapBandIndicator<Scalar>::Stream::update(const Candle& c) -> Point {
+  return update(c.close, c.volume);
+}
 
-  for (std::size_t i = 0; i < candles.size(); ++i) {
-    const auto& c = candles[i];
-    const double price = c.close;
-    const double pv = price * c.volume;
-
-    pv_window.push_back(pv);
-    v_window.push_back(c.volume);
-    price_window.push_back(price);
-
-    pv_sum += pv;
-    v_sum += c.volume;
-    price_sum += price;
-    price_sq_sum += price * price;
-
-    if (pv_window.size() > config_.window) {
-      pv_sum -= pv_window.front();
-      v_sum -= v_window.front();
-      price_sum -= price_window.front();
-      price_sq_sum -= price_window.front() * price_window.front();
-      pv_window.pop_front();
-      v_window.pop_front();
-      price_window.pop_front();
-    }
-
-    double vwap = v_sum > 0.0 ? pv_sum / v_sum : price;
-    const double mean = price_sum / static_cast<double>(price_window.size());
-    double variance =
-        price_sq_sum / static_cast<double>(price_window.size()) - mean * mean;
-    if (variance < 0.0) variance = 0.0;
-    const double stddev = std::sqrt(variance);
-    const double offset = stddev * config_.band_deviation;
-    const double upper = vwap + offset;
-    const double lower = vwap - offset;
-
-    Signal signal = Signal::Flat;
-    if (price < lower) {
-      signal = Signal::Long;
-    } else if (price > upper) {
-      signal = Signal::Short;
-    }
-
-    out.push_back({i, c.timestamp, vwap, upper, lower, signal});
+template <typename Scalar>
+auto BasicVwapBandIndicator<Scalar>::Stream::update(double close, double volume) -> Point {
+  const Scalar price = static_cast<Scalar>(close);
+  const Scalar vol = static_cast<Scalar>(volume);
+  const Scalar pv = static_cast<Scalar>(close * volume);
+
+  pv_window_.push_back(pv);
+  v_window_.push_back(vol);
+  price_window_.push_back(price);
+  pv_sum_.add(pv);
+  v_sum_.add(vol);
+
+  if (price_window_.size() > config_.window) {
+    pv_sum_.add(-pv_window_.front());
+    v_sum_.add(-v_window_.front());
+    price_.replace(price_window_.front(), price, config_.window);
+    pv_window_.pop_front();
+    v_window_.pop_front();
+    price_window_.pop_front();
+  } else {
+    price_.push(price, price_window_.size());
   }
 
-  return out;
+  const Scalar v_sum = v_sum_.value();
+  const Scalar vwap = v_sum > Scalar{0} ? pv_sum_.value() / v_sum : price;
+  const Scalar stddev = std::sqrt(price_.variance(price_window_.size()));
+  const Scalar offset = stddev * static_cast<Scalar>(config_.band_deviation);
+  const Scalar upper = vwap + offset;
+  const Scalar lower = vwap - offset;
+
+  Signal signal = Signal::Flat;
+  if (price < lower) {
+    signal = Signal::Long;
+  } else if (price > upper) {
+    signal = Signal::Short;
+  }
+
+  return {vwap, upper, lower, signal};
 }
 
+template <typename Scalar>
+void BasicVwapBandIndicator<Scalar>::Stream::save(StateWriter& out) const {
+  out.put(config_.window);
+  out.put(config_.band_deviation);
+  out.put(pv_window_);
+  out.put(v_window_);
+  out.put(price_window_);
+  out.put(pv_sum_.sum);
+  out.put(pv_sum_.carry);
+  out.put(v_sum_.sum);
+  out.put(v_sum_.carry);
+  out.put(price_.mean.sum);
+  out.put(price_.mean.carry);
+  out.put(price_.m2.sum);
+  out.put(price_.m2.carry);
+}
+
+template <typename Scalar>
+bool BasicVwapBandIndicator<Scalar>::Stream::restore(StateReader& in) {
+  return in.expect(config_.window) && in.expect(config_.band_deviation) &&
+         in.get(pv_window_) && in.get(v_window_) && in.get(price_window_) &&
+         in.get(pv_sum_.sum) && in.get(pv_sum_.carry) && in.get(v_sum_.sum) &&
+         in.get(v_sum_.carry) && in.get(price_.mean.sum) && in.get(price_.mean.carry) &&
+         in.get(price_.m2.sum) && in.get(price_.m2.carry);
+}
+
+template class BasicVwapBandIndicator<float>;
+template class BasicVwapBandIndicator<double>;
+
 }  // namespace lwti
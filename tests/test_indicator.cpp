@@ -1,18 +1,22 @@
 #define CATCH_CONFIG_MAIN
 #include "catch_amalgamated.hpp"
 
+#include <cmath>
 #include <vector>
 
+#include "core/candle_series.hpp"
 #include "indicator.hpp"
+#include "indicators/regime.hpp"
+#include "indicators/vwap_band.hpp"
 
 using namespace lwti;
 
 TEST_CASE("indicator returns same size and initial flat signals") {
   LiquidityWeightedTrendIndicator indicator;
   std::vector<Candle> candles{
-      {"t1", 100, 101, 99, 100, 1000},
-      {"t2", 101, 102, 100, 101, 1000},
-      {"t3", 102, 103, 101, 102, 1000},
+      {1, 100, 101, 99, 100, 1000},
+      {2, 101, 102, 100, 101, 1000},
+      {3, 102, 103, 101, 102, 1000},
   };
 
   auto result = indicator.compute(candles);
@@ -29,9 +33,9 @@ TEST_CASE("uptrend generates long bias") {
 
   LiquidityWeightedTrendIndicator indicator(cfg);
   std::vector<Candle> candles{
-      {"t1", 100, 101, 99, 100, 1000}, {"t2", 101, 102, 100, 101, 1200},
-      {"t3", 102, 103, 101, 102, 1400}, {"t4", 103, 104, 102, 103, 1500},
-      {"t5", 104, 105, 103, 104, 1600}, {"t6", 105, 106, 104, 105, 1700}};
+      {1, 100, 101, 99, 100, 1000}, {2, 101, 102, 100, 101, 1200},
+      {3, 102, 103, 101, 102, 1400}, {4, 103, 104, 102, 103, 1500},
+      {5, 104, 105, 103, 104, 1600}, {6, 105, 106, 104, 105, 1700}};
 
   auto result = indicator.compute(candles);
   REQUIRE(result.size() == candles.size());
@@ -48,9 +52,9 @@ TEST_CASE("downtrend generates short bias") {
 
   LiquidityWeightedTrendIndicator indicator(cfg);
   std::vector<Candle> candles{
-      {"t1", 105, 106, 104, 105, 1700}, {"t2", 104, 105, 103, 104, 1600},
-      {"t3", 103, 104, 102, 103, 1500}, {"t4", 102, 103, 101, 102, 1400},
-      {"t5", 101, 102, 100, 101, 1300}, {"t6", 100, 101, 99, 100, 1200}};
+      {1, 105, 106, 104, 105, 1700}, {2, 104, 105, 103, 104, 1600},
+      {3, 103, 104, 102, 103, 1500}, {4, 102, 103, 101, 102, 1400},
+      {5, 101, 102, 100, 101, 1300}, {6, 100, 101, 99, 100, 1200}};
 
   auto result = indicator.compute(candles);
   REQUIRE(result.size() == candles.size());
@@ -67,9 +71,9 @@ TEST_CASE("high volume speeds trend adjustment") {
 
   LiquidityWeightedTrendIndicator indicator(cfg);
   std::vector<Candle> low_vol{
-      {"t1", 100, 100, 100, 100, 1},
-      {"t2", 110, 110, 110, 110, 1},
-      {"t3", 110, 110, 110, 110, 1},
+      {1, 100, 100, 100, 100, 1},
+      {2, 110, 110, 110, 110, 1},
+      {3, 110, 110, 110, 110, 1},
   };
   std::vector<Candle> high_vol = low_vol;
   high_vol[1].volume = 50.0;  // spike volume on second bar
@@ -81,3 +85,40 @@ TEST_CASE("high volume speeds trend adjustment") {
   // With larger volume, EMA should react more to the second bar.
   CHECK(boosted[1].lw_ema > base[1].lw_ema);
 }
+
+TEST_CASE("float engines track double over a million bars") {
+  // A price far from zero with small moves is where sum-of-squares variance
+  // cancels catastrophically in float.
+  CandleSeries series;
+  std::uint64_t state = 7;
+  double close = 1000.0;
+  for (int i = 0; i < (1 << 20); ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    close += (static_cast<double>(state >> 40) / (1 << 24) - 0.5) * 0.2;
+    series.push_back({i, close, close + 0.05, close - 0.05, close, 100.0 + (state >> 60)});
+  }
+
+  VwapBandConfig vwap_cfg;
+  vwap_cfg.window = 50;
+  const auto vwap_d = BasicVwapBandIndicator<double>(vwap_cfg).compute(series);
+  const auto vwap_f = BasicVwapBandIndicator<float>(vwap_cfg).compute(series);
+  const auto lwti_d = BasicLiquidityWeightedTrendIndicator<double>().compute(series);
+  const auto lwti_f = BasicLiquidityWeightedTrendIndicator<float>().compute(series);
+  const auto regime_d = BasicVolatilityRegimeIndicator<double>().compute(series);
+  const auto regime_f = BasicVolatilityRegimeIndicator<float>().compute(series);
+
+  double band_error = 0.0;
+  double vol_error = 0.0;
+  for (std::size_t i = 1000; i < series.size(); ++i) {
+    const double width_d = vwap_d[i].upper - vwap_d[i].lower;
+    const double width_f = static_cast<double>(vwap_f[i].upper) - vwap_f[i].lower;
+    band_error = std::max(band_error, std::abs(width_f - width_d) / width_d);
+    vol_error = std::max(vol_error, std::abs(lwti_f[i].volatility - lwti_d[i].volatility) /
+                                        lwti_d[i].volatility);
+    vol_error = std::max(vol_error, std::abs(regime_f[i].realized_vol - regime_d[i].realized_vol) /
+                                        regime_d[i].realized_vol);
+  }
+  CHECK(band_error < 0.02);
+  CHECK(vol_error < 0.01);
+  CHECK(std::abs(vwap_f.back().vwap - vwap_d.back().vwap) < 0.01);
+}
@@ -0,0 +1,769 @@
+#include "catch_amalgamated.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "core/time.hpp"
+#include "csv_reader.hpp"
+#include "io/candle_cache.hpp"
+#include "io/candle_loader.hpp"
+#include "io/candle_source.hpp"
+#include "io/candle_store.hpp"
+#include "io/candle_validation.hpp"
+#include "io/csv_index.hpp"
+#include "io/dataset.hpp"
+#include "io/mapped_file.hpp"
+#include "io/read_ahead.hpp"
+#include "io/structural_scanner.hpp"
+#include "io/tick_reader.hpp"
+
+using namespace lwti;
+
+namespace {
+
+std::string write_temp_csv(const std::string& name, const std::string& contents) {
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream out(path, std::ios::binary);
+  out << contents;
+  return path.string();
+}
+
+// ISO text for the given minute after 2024-01-01T00:00:00Z.
+std::string minute_ts(int minute) {
+  return format_timestamp(1704067200 * kNanosPerSecond + Timestamp{minute} * 60 * kNanosPerSecond);
+}
+
+}  // namespace
+
+TEST_CASE("csv reader skips header and malformed rows") {
+  const auto path = write_temp_csv(
+      "lwti_test_malformed.csv",
+      "timestamp,open,high,low,close,volume\r\n"
+      "2024-01-01T00:01:00Z,100.0,101.0,99.5,100.5,1200\r\n"
+      "\n"
+      " 2024-01-01T00:02:00Z , 100.5 ,101.2,100.1,101.0,1400\n"
+      "2024-01-01T00:03:00Z,abc,101.8,100.8,101.6,1800\n"
+      "2024-01-01T00:04:00Z,101.6,102.4,101.4\n"
+      "2024-01-01T00:05:00Z,102.8x,103.4,102.5,103.2,2000\n"
+      "2024-13-01T00:05:00Z,102.8,103.4,102.5,103.2,2000\n"
+      "2024-01-01T00:06:00Z,+103.8,104.6,103.6,104.4,2500,extra\n"
+      "2024-01-01 00:07,1,2,3,4,5");
+
+  const auto candles = read_candles_csv(path);
+  REQUIRE(candles.size() == 4);
+  CHECK(format_timestamp(candles[0].timestamp) == minute_ts(1));
+  CHECK(format_timestamp(candles[1].timestamp) == minute_ts(2));
+  CHECK(candles[1].open == 100.5);
+  CHECK(format_timestamp(candles[2].timestamp) == minute_ts(6));
+  CHECK(candles[2].open == 103.8);
+  CHECK(format_timestamp(candles[3].timestamp) == minute_ts(7));
+  CHECK(candles[3].volume == 5.0);
+}
+
+TEST_CASE("csv reader returns empty series for missing file") {
+  CHECK(read_candles_csv("/nonexistent/lwti.csv").empty());
+}
+
+TEST_CASE("parallel csv read matches serial read") {
+  std::string contents = "timestamp,open,high,low,close,volume\n";
+  for (int i = 0; i < 80000; ++i) {
+    const std::string ts = minute_ts(i);
+    if (i % 997 == 0) {
+      contents += ts + ",bad,1,1,1,1\n";
+    } else if (i % 1301 == 0) {
+      contents += ts + ",1,1,1\n";
+    } else {
+      contents += ts + "," + std::to_string(100 + i % 50) + ".25,101.5,99.75,100.5," +
+                  std::to_string(1000 + i) + "\n";
+    }
+  }
+  const auto path = write_temp_csv("lwti_test_parallel.csv", contents);
+
+  const auto serial = read_candles_csv(path, 1);
+  const auto parallel = read_candles_csv(path, 4);
+  REQUIRE(serial.size() == parallel.size());
+  REQUIRE(serial.size() < 80000);
+  for (std::size_t i = 0; i < serial.size(); ++i) {
+    REQUIRE(serial[i].timestamp == parallel[i].timestamp);
+    REQUIRE(serial[i].open == parallel[i].open);
+    REQUIRE(serial[i].volume == parallel[i].volume);
+  }
+}
+
+TEST_CASE("structural scanner marks commas and newlines") {
+  std::string block(kScanBlock, 'x');
+  block[0] = ',';
+  block[17] = '\n';
+  block[33] = ',';
+  block[63] = '\n';
+
+  const auto masks = scan_block(block.data());
+  CHECK(masks.comma == ((std::uint64_t{1} << 0) | (std::uint64_t{1} << 33)));
+  CHECK(masks.newline == ((std::uint64_t{1} << 17) | (std::uint64_t{1} << 63)));
+}
+
+TEST_CASE("row walker reports fields across block boundaries") {
+  std::string text(70, 'a');
+  text += ",b,c\nd,e";
+  std::vector<std::size_t> counts;
+  std::vector<std::string> seconds;
+  for_each_row<2>(text.data(), text.data() + text.size(),
+                  [&](std::string_view, const auto& fields, std::size_t count) {
+                    counts.push_back(count);
+                    seconds.emplace_back(fields[1]);
+                  });
+  REQUIRE(counts == std::vector<std::size_t>{3, 2});
+  CHECK(seconds[0] == "b");
+  CHECK(seconds[1] == "e");
+}
+
+TEST_CASE("candle source batches match full read") {
+  std::string contents = "\nshort,line\ntimestamp,open,high,low,close,volume\n";
+  for (int i = 0; i < 3000; ++i) {
+    contents += minute_ts(i) + (i % 101 == 0 ? ",x" : ",1.5") + ",2,1,1.75," +
+                std::to_string(i) + "\n";
+  }
+  contents += std::string(5000, 'z') + "\n" + minute_ts(9999) + ",1,2,3,4,5";
+  const auto path = write_temp_csv("lwti_test_source.csv", contents);
+
+  const auto expected = read_candles_csv(path);
+  CsvCandleSource source(path, 4096);
+  REQUIRE(source.is_open());
+
+  std::vector<Candle> streamed;
+  std::vector<Candle> batch;
+  std::size_t batches = 0;
+  while (source.next(batch)) {
+    ++batches;
+    streamed.insert(streamed.end(), batch.begin(), batch.end());
+  }
+  CHECK(batches > 1);
+  REQUIRE(streamed.size() == expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    REQUIRE(streamed[i].timestamp == expected[i].timestamp);
+    REQUIRE(streamed[i].volume == expected[i].volume);
+  }
+  CHECK(format_timestamp(streamed.back().timestamp) == minute_ts(9999));
+}
+
+TEST_CASE("candle cache round-trips and rejects stale sources") {
+  const auto path = write_temp_csv("lwti_test_cache.csv",
+                                   "timestamp,open,high,low,close,volume\n"
+                                   "2024-01-01T00:01:00Z,1,2,0.5,1.5,10\n"
+                                   "2024-01-01T00:02:00Z,1.5,2.5,1,2,20\n");
+  const auto candles = read_candles_csv(path);
+  const auto source = sampled_fingerprint(path);
+  REQUIRE(source);
+
+  const auto cache_path = candle_cache_path(path);
+  REQUIRE(write_candle_cache(cache_path, *source, candles));
+  const auto cached = read_candle_cache(cache_path, *source);
+  REQUIRE(cached);
+  REQUIRE(cached->size() == 2);
+  CHECK((*cached)[1].timestamp == (*cached)[0].timestamp + 60 * kNanosPerSecond);
+  CHECK((*cached)[1].close == 2.0);
+  CHECK((*cached)[0].volume == 10.0);
+
+  SourceFingerprint changed = *source;
+  changed.hash ^= 1;
+  CHECK_FALSE(read_candle_cache(cache_path, changed));
+}
+
+TEST_CASE("timestamps parse to epoch nanoseconds and format back") {
+  Timestamp ts = 0;
+  REQUIRE(parse_timestamp("2023-01-01T10:00:00Z", ts));
+  CHECK(ts == 1672567200 * kNanosPerSecond);
+  CHECK(format_timestamp(ts) == "2023-01-01T10:00:00Z");
+
+  REQUIRE(parse_timestamp("2023-01-01T12:30:00.25+02:30", ts));
+  CHECK(format_timestamp(ts) == "2023-01-01T10:00:00.250Z");
+  REQUIRE(parse_timestamp("1969-12-31 23:59:59.000000001", ts));
+  CHECK(ts == -kNanosPerSecond + 1);
+  CHECK(format_timestamp(ts) == "1969-12-31T23:59:59.000000001Z");
+  REQUIRE(parse_timestamp("2024-02-29", ts));
+  CHECK(format_timestamp(ts) == "2024-02-29T00:00:00Z");
+
+  CHECK_FALSE(parse_timestamp("2023-02-29T00:00:00Z", ts));
+  CHECK_FALSE(parse_timestamp("2023-01-01T24:00:00Z", ts));
+  CHECK_FALSE(parse_timestamp("2023-01-01T10:00:00Q", ts));
+  CHECK_FALSE(parse_timestamp("t1", ts));
+}
+
+TEST_CASE("multiple inputs are merged by timestamp with boundary duplicates dropped") {
+  const auto dir = std::filesystem::temp_directory_path() / "lwti_test_multi";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  auto write_part = [&](const std::string& name, int first, int last, double close) {
+    std::ofstream out(dir / name);
+    out << "timestamp,open,high,low,close,volume\n";
+    for (int m = first; m <= last; ++m) {
+      out << minute_ts(m) << ",1,2,0.5," << close << ",10\n";
+    }
+  };
+  write_part("day2.csv", 3, 7, 2.0);
+  write_part("day1.csv", 0, 4, 1.0);
+  write_part("day3.csv", 8, 9, 3.0);
+  write_part("notes.txt", 20, 21, 9.0);
+
+  DataConfig cfg;
+  cfg.cache = false;
+  cfg.threads = 2;
+  for (const auto& spec : {dir.string(), (dir / "day*.csv").string()}) {
+    cfg.inputs = {spec};
+    const auto merged = load_candles(cfg);
+    REQUIRE(merged.size() == 10);
+    for (std::size_t i = 0; i < merged.size(); ++i) {
+      REQUIRE(format_timestamp(merged[i].timestamp) == minute_ts(static_cast<int>(i)));
+    }
+    CHECK(merged[4].close == 1.0);  // day1 is listed first and wins the tie
+    CHECK(merged[5].close == 2.0);
+    CHECK(merged[9].close == 3.0);
+  }
+
+  cfg.inputs = {dir.string()};
+  auto source = open_candle_source(cfg);
+  REQUIRE(source);
+  std::vector<Candle> streamed;
+  std::vector<Candle> batch;
+  while (source->next(batch)) {
+    streamed.insert(streamed.end(), batch.begin(), batch.end());
+  }
+  const auto loaded = load_candles(cfg);
+  REQUIRE(streamed.size() == loaded.size());
+  for (std::size_t i = 0; i < loaded.size(); ++i) {
+    CHECK(streamed[i].timestamp == loaded[i].timestamp);
+    CHECK(streamed[i].close == loaded[i].close);
+  }
+
+  // A repeat inside one file survives the merge, as it does when the file
+  // is loaded alone.
+  std::ofstream(dir / "day3.csv", std::ios::app) << minute_ts(9) << ",1,2,0.5,4,10\n";
+  cfg.inputs = {(dir / "day3.csv").string()};
+  REQUIRE(load_candles(cfg).size() == 3);
+  cfg.inputs = {dir.string()};
+  const auto with_repeat = load_candles(cfg);
+  REQUIRE(with_repeat.size() == 11);
+  CHECK(with_repeat[9].close == 3.0);
+  CHECK(with_repeat[10].close == 4.0);
+  source = open_candle_source(cfg);
+  streamed.clear();
+  while (source->next(batch)) {
+    streamed.insert(streamed.end(), batch.begin(), batch.end());
+  }
+  CHECK(streamed.size() == 11);
+}
+
+TEST_CASE("header plan maps reordered columns and skips extras") {
+  const auto path = write_temp_csv(
+      "lwti_test_wide.csv",
+      "symbol,VWAP,Close,ts,trades,Open,High,Low,Volume\n"
+      "AAA,1.1," + minute_ts(1) + ",x,7,1.0,2.0,0.5,100\n"  // timestamp in the close slot
+      "AAA,1.1,1.5," + minute_ts(2) + ",7,1.0,2.0,0.5,100\n"
+      "AAA,1.1,1.6," + minute_ts(3) + ",7,1.0,2.0,0.5\n"  // too few columns
+      "AAA,,1.7," + minute_ts(4) + ",,1.1,2.1,0.6,200,tail\n");
+
+  const auto candles = read_candles_csv(path);
+  REQUIRE(candles.size() == 2);
+  CHECK(format_timestamp(candles[0].timestamp) == minute_ts(2));
+  CHECK(candles[0].close == 1.5);
+  CHECK(candles[0].open == 1.0);
+  CHECK(candles[1].close == 1.7);
+  CHECK(candles[1].low == 0.6);
+  CHECK(candles[1].volume == 200.0);
+
+  CHECK_FALSE(plan_from_header("timestamp,open,high,low,close"));
+  const auto plan = plan_from_header("v,c,l,h,o,time");
+  REQUIRE(plan);
+  CHECK(plan->columns[ColumnPlan::kTimestamp] == 5);
+  CHECK(plan->min_fields == 6);
+}
+
+TEST_CASE("ticks aggregate into bars of several intervals in one pass") {
+  Timestamp minute = 0;
+  REQUIRE(parse_duration("1m", minute));
+  REQUIRE(minute == 60 * kNanosPerSecond);
+  Timestamp five = 0;
+  REQUIRE(parse_duration("5m", five));
+  REQUIRE_FALSE(parse_duration("5x", five));
+  // Too long for an int64 of nanoseconds: rejected, not wrapped.
+  Timestamp longest = 0;
+  REQUIRE_FALSE(parse_duration("999999999999d", longest));
+  REQUIRE_FALSE(parse_duration("106752d", longest));
+  REQUIRE(parse_duration("106751d", longest));
+
+  const auto path = write_temp_csv(
+      "lwti_test_ticks.csv",
+      "size,timestamp,price\n"
+      "1," + minute_ts(0) + ",100\n"
+      "2," + minute_ts(0) + ",102\n"
+      "1," + minute_ts(1) + ",99\n"
+      "5," + minute_ts(0) + ",150\n"  // late for 1m bars, still inside the 5m one
+      "not,a,tick\n"
+      "3," + minute_ts(6) + ",101\n");
+
+  const auto bars = aggregate_tick_files({path}, {minute, five});
+  REQUIRE(bars.size() == 2);
+  REQUIRE(bars[0].size() == 3);
+  REQUIRE(bars[0][0].timestamp == 1704067200 * kNanosPerSecond);
+  REQUIRE(bars[0][0].open == Catch::Approx(100.0));
+  REQUIRE(bars[0][0].high == Catch::Approx(102.0));
+  REQUIRE(bars[0][0].close == Catch::Approx(102.0));
+  REQUIRE(bars[0][0].volume == Catch::Approx(3.0));
+  REQUIRE(bars[0][2].timestamp == bars[0][0].timestamp + 6 * minute);
+
+  REQUIRE(bars[1].size() == 2);
+  REQUIRE(bars[1][0].low == Catch::Approx(99.0));
+  REQUIRE(bars[1][0].high == Catch::Approx(150.0));
+  REQUIRE(bars[1][0].volume == Catch::Approx(9.0));
+  REQUIRE(bars[1][1].timestamp == bars[1][0].timestamp + five);
+
+  TickBarSource source({path}, minute, 64);
+  std::vector<Candle> streamed;
+  std::vector<Candle> batch;
+  while (source.next(batch)) {
+    streamed.insert(streamed.end(), batch.begin(), batch.end());
+  }
+  REQUIRE(streamed.size() == bars[0].size());
+  for (std::size_t i = 0; i < streamed.size(); ++i) {
+    REQUIRE(streamed[i].timestamp == bars[0][i].timestamp);
+    REQUIRE(streamed[i].volume == Catch::Approx(bars[0][i].volume));
+  }
+}
+
+TEST_CASE("resampling rolls minute candles up to coarser bars") {
+  std::string csv = "timestamp,open,high,low,close,volume\n";
+  for (int m = 0; m < 12; ++m) {
+    const double base = 100.0 + m;
+    csv += minute_ts(m) + "," + std::to_string(base) + "," + std::to_string(base + 5) + "," +
+           std::to_string(base - 1) + "," + std::to_string(base + 0.5) + ",10\n";
+  }
+  const auto path = write_temp_csv("lwti_test_resample.csv", csv);
+
+  DataConfig config;
+  config.inputs = {path};
+  config.cache = false;
+  REQUIRE(parse_duration("5m", config.resample));
+  const auto bars = load_candles(config);
+  REQUIRE(bars.size() == 3);
+  REQUIRE(bars[0].timestamp == 1704067200 * kNanosPerSecond);
+  REQUIRE(bars[0].open == Catch::Approx(100.0));
+  REQUIRE(bars[0].high == Catch::Approx(109.0));
+  REQUIRE(bars[0].low == Catch::Approx(99.0));
+  REQUIRE(bars[0].close == Catch::Approx(104.5));
+  REQUIRE(bars[0].volume == Catch::Approx(50.0));
+  REQUIRE(bars[2].open == Catch::Approx(110.0));
+  REQUIRE(bars[2].volume == Catch::Approx(20.0));
+
+  auto source = open_candle_source(config);
+  REQUIRE(source != nullptr);
+  std::vector<Candle> streamed;
+  std::vector<Candle> batch;
+  while (source->next(batch)) {
+    streamed.insert(streamed.end(), batch.begin(), batch.end());
+  }
+  REQUIRE(streamed.size() == bars.size());
+  for (std::size_t i = 0; i < bars.size(); ++i) {
+    REQUIRE(streamed[i].timestamp == bars[i].timestamp);
+    REQUIRE(streamed[i].close == Catch::Approx(bars[i].close));
+  }
+}
+
+TEST_CASE("candle store round-trips losslessly across blocks") {
+  std::vector<Candle> candles;
+  Timestamp ts = 1704067200 * kNanosPerSecond;
+  for (int i = 0; i < 50; ++i) {
+    ts += (i % 7 == 0 ? 120 : 60) * kNanosPerSecond;
+    const double close = 100.25 + 0.01 * i;
+    candles.push_back({ts, close - 0.5, close + 1.125, close - 1.0, close, 1000.0 + i * 3});
+  }
+  candles[20].volume = 1.0 / 3.0;  // no exact decimal scale: stored raw
+  candles[21].close = -2.5;
+
+  const auto path = (std::filesystem::temp_directory_path() / "lwti_test_store.lwts").string();
+  REQUIRE(is_candle_store(path));
+  REQUIRE(write_candle_store(path, candles, 16));
+
+  const auto loaded = read_candle_store(path);
+  REQUIRE(loaded.has_value());
+  REQUIRE(loaded->size() == candles.size());
+  for (std::size_t i = 0; i < candles.size(); ++i) {
+    REQUIRE((*loaded)[i].timestamp == candles[i].timestamp);
+    REQUIRE((*loaded)[i].open == candles[i].open);
+    REQUIRE((*loaded)[i].high == candles[i].high);
+    REQUIRE((*loaded)[i].low == candles[i].low);
+    REQUIRE((*loaded)[i].close == candles[i].close);
+    REQUIRE((*loaded)[i].volume == candles[i].volume);
+  }
+
+  StoreCandleSource source(path);
+  REQUIRE(source.is_open());
+  std::vector<Candle> batch;
+  std::size_t batches = 0;
+  std::size_t rows = 0;
+  while (source.next(batch)) {
+    ++batches;
+    rows += batch.size();
+  }
+  REQUIRE(batches == 4);
+  REQUIRE(rows == candles.size());
+
+  const auto index = read_store_index(path);
+  REQUIRE(index.has_value());
+  {
+    // A huge row count in a block header is rejected before any allocation.
+    std::fstream corrupt(path, std::ios::binary | std::ios::in | std::ios::out);
+    corrupt.seekp(static_cast<std::streamoff>(index->front().offset));
+    const std::uint32_t bogus_rows = 0xFFFFFFFF;
+    corrupt.write(reinterpret_cast<const char*>(&bogus_rows), sizeof(bogus_rows));
+  }
+  REQUIRE_FALSE(read_candle_store(path).has_value());
+  REQUIRE(write_candle_store(path, candles, 16));
+
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+  REQUIRE_FALSE(read_candle_store(path).has_value());
+}
+
+TEST_CASE("candle store rejects a corrupt block index") {
+  std::vector<Candle> candles;
+  for (int i = 1; i <= 40; ++i) {
+    candles.push_back({Timestamp{i} * 60 * kNanosPerSecond, 1, 2, 0.5, 1.5, 10});
+  }
+  const auto path = (std::filesystem::temp_directory_path() / "lwti_test_index.lwts").string();
+  const auto index_offset = [&] {
+    const std::uint64_t blocks = read_store_index(path)->size();
+    return std::filesystem::file_size(path) - blocks * sizeof(StoreBlockInfo);
+  };
+  const auto patch = [&](std::uint64_t at, std::uint64_t value) {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(at));
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  constexpr std::uint64_t kHeaderRows = 16;  // magic, version, endian tag
+
+  // A huge block row count, with the header total adjusted to match.
+  REQUIRE(write_candle_store(path, candles, 16));
+  std::uint64_t at = index_offset();
+  patch(at + sizeof(std::uint64_t), std::uint64_t{1} << 60);
+  patch(kHeaderRows, (std::uint64_t{1} << 60) + 24);
+  REQUIRE_FALSE(read_store_index(path).has_value());
+  REQUIRE_FALSE(read_candle_store(path).has_value());
+
+  // Blocks out of order.
+  REQUIRE(write_candle_store(path, candles, 16));
+  const auto index = read_store_index(path);
+  REQUIRE(index->size() == 3);
+  at = index_offset();
+  patch(at, (*index)[1].offset);
+  patch(at + sizeof(StoreBlockInfo), (*index)[0].offset);
+  REQUIRE_FALSE(read_candle_store(path).has_value());
+}
+
+TEST_CASE("csv source resumes at a saved position and holds back an unterminated row") {
+  const std::string header = "timestamp,open,high,low,close,volume\n";
+  const std::string row1 = minute_ts(1) + ",1,2,0.5,1.5,10\n";
+  const std::string row2 = minute_ts(2) + ",1.5,2.5,1,2,20\n";
+  const auto path = write_temp_csv("lwti_test_follow.csv", header + row1 + row2.substr(0, 10));
+
+  std::vector<Candle> batch;
+  CsvCandleSource first(path, CsvPosition{});
+  REQUIRE(first.next(batch));
+  REQUIRE(batch.size() == 1);
+  REQUIRE_FALSE(first.next(batch));
+  const CsvPosition saved = first.position();
+  REQUIRE(saved.offset == header.size() + row1.size());
+  REQUIRE(saved.header_resolved);
+
+  std::ofstream(path, std::ios::binary | std::ios::app) << row2.substr(10);
+  CsvCandleSource second(path, saved);
+  REQUIRE(second.next(batch));
+  REQUIRE(batch.size() == 1);
+  REQUIRE(batch[0].close == Catch::Approx(2.0));
+  REQUIRE_FALSE(second.next(batch));
+  REQUIRE(second.position().offset == header.size() + row1.size() + row2.size());
+}
+
+TEST_CASE("time-range loads seek through the store index and the cache") {
+  std::vector<Candle> candles;
+  std::string csv = "timestamp,open,high,low,close,volume\n";
+  for (int m = 0; m < 100; ++m) {
+    const double close = 50.0 + m;
+    candles.push_back({1704067200 * kNanosPerSecond + Timestamp{m} * 60 * kNanosPerSecond, close,
+                       close + 1, close - 1, close, 10.0 + m});
+    csv += minute_ts(m) + "," + std::to_string(close) + "," + std::to_string(close + 1) + "," +
+           std::to_string(close - 1) + "," + std::to_string(close) + "," +
+           std::to_string(10 + m) + "\n";
+  }
+  const auto store = (std::filesystem::temp_directory_path() / "lwti_test_range.lwts").string();
+  REQUIRE(write_candle_store(store, candles, 32));
+
+  const auto index = read_store_index(store);
+  REQUIRE(index.has_value());
+  REQUIRE(index->size() == 4);
+  REQUIRE((*index)[1].min_timestamp == candles[32].timestamp);
+  REQUIRE((*index)[1].max_timestamp == candles[63].timestamp);
+  REQUIRE((*index)[1].min_close == Catch::Approx(82.0));
+  REQUIRE((*index)[3].max_volume == Catch::Approx(109.0));
+
+  TimeRange range{candles[40].timestamp, candles[70].timestamp};
+  const auto slice = read_candle_store(store, range);
+  REQUIRE(slice.has_value());
+  REQUIRE(slice->size() == 30);
+  REQUIRE(slice->front().timestamp == candles[40].timestamp);
+  REQUIRE(slice->back().timestamp == candles[69].timestamp);
+
+  DataConfig config;
+  config.inputs = {write_temp_csv("lwti_test_range.csv", csv)};
+  config.range = range;
+  std::filesystem::remove(candle_cache_path(config.inputs.front()));
+  for (int pass = 0; pass < 2; ++pass) {  // parse + write the cache, then read it
+    const auto loaded = load_candles(config);
+    REQUIRE(loaded.size() == 30);
+    REQUIRE(loaded.front().timestamp == candles[40].timestamp);
+  }
+}
+
+TEST_CASE("read-ahead returns the file bytes in order on every backend") {
+  std::string contents;
+  for (int i = 0; i < 20000; ++i) {
+    contents += std::to_string(i * 7919) + ",";
+  }
+  const auto path = write_temp_csv("lwti_test_read_ahead.bin", contents);
+  const auto empty = write_temp_csv("lwti_test_read_ahead_empty.bin", "");
+
+  for (const auto backend : {ReadAhead::Backend::kAuto, ReadAhead::Backend::kPread}) {
+    for (const std::size_t start : {std::size_t{0}, std::size_t{5000}}) {
+      ReadAhead reader(path, start, backend, 4096, 3);
+      REQUIRE(reader.is_open());
+      std::string read;
+      char buffer[3000];
+      while (const std::size_t n = reader.read(buffer, sizeof(buffer))) {
+        read.append(buffer, n);
+      }
+      REQUIRE(read == contents.substr(start));
+    }
+    ReadAhead nothing(empty, 0, backend);
+    char byte = 0;
+    REQUIRE(nothing.read(&byte, 1) == 0);
+  }
+  REQUIRE_FALSE(ReadAhead("/nonexistent/lwti.csv").is_open());
+}
+
+TEST_CASE("validation counts bad bars and repairs order in parallel") {
+  std::vector<Candle> candles;
+  for (int i = 0; i < 200000; ++i) {
+    const double close = 100.0 + (i % 50) * 0.1;
+    candles.push_back({Timestamp{i} * 60, close, close + 0.5, close - 0.5, close, 10.0});
+  }
+  candles[3].high = candles[3].close - 1.0;
+  candles[4].low = candles[4].open + 1.0;
+  candles[5].volume = -1.0;
+  candles[6].close = 0.0;
+  candles[6].low = 0.0;
+  std::swap(candles[1000], candles[150000]);
+  candles[90000].timestamp = candles[10].timestamp;
+  candles[90000].open = -7.0;
+
+  auto expected = candles;
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const Candle& a, const Candle& b) { return a.timestamp < b.timestamp; });
+  expected.erase(std::unique(expected.begin(), expected.end(),
+                             [](const Candle& a, const Candle& b) {
+                               return a.timestamp == b.timestamp;
+                             }),
+                 expected.end());
+
+  const auto report = validate_candles(candles, 4);
+  CHECK(report.rows == 200000);
+  CHECK(report.bad_high == 1);
+  CHECK(report.bad_low == 2);  // the negative open also sits below its low
+  CHECK(report.negative_volume == 1);
+  CHECK(report.zero_price == 2);
+  CHECK(report.out_of_order == 3);
+  CHECK(report.duplicates == 1);
+  REQUIRE(candles.size() == expected.size());
+  for (std::size_t i = 0; i < candles.size(); ++i) {
+    REQUIRE(candles[i].timestamp == expected[i].timestamp);
+    REQUIRE(candles[i].open == expected[i].open);
+  }
+  // The first bar at a repeated timestamp wins, so the bad print is gone.
+  CHECK(check_candles(candles).zero_price == 1);
+}
+
+TEST_CASE("long-format csv is partitioned by symbol in file order") {
+  const char* symbols[] = {"MSFT", "AAPL", "IBM"};
+  std::string csv = "ts,Symbol,open,high,low,close,volume,venue\n";
+  for (int i = 0; i < 60000; ++i) {
+    const double close = 100.0 + i % 17;
+    csv += minute_ts(i / 3) + "," + symbols[i % 3] + "," + std::to_string(close) + "," +
+           std::to_string(close + 1) + "," + std::to_string(close - 1) + "," +
+           std::to_string(close) + "," + std::to_string(i) + ",X\n";
+    if (i == 100) csv += minute_ts(i) + ",IBM,bad,1,1,1,1,X\n";
+  }
+  const auto path = write_temp_csv("lwti_by_symbol.csv", csv);
+
+  const auto serial = read_symbol_candles_csv(path, 1);
+  const auto parallel = read_symbol_candles_csv(path, 4);
+  REQUIRE(serial.size() == 3);
+  CHECK(serial[0].symbol == "AAPL");
+  CHECK(serial[1].symbol == "IBM");
+  CHECK(serial[2].symbol == "MSFT");
+  REQUIRE(parallel.size() == serial.size());
+  for (std::size_t s = 0; s < serial.size(); ++s) {
+    REQUIRE(serial[s].candles.size() == 20000);
+    REQUIRE(parallel[s].symbol == serial[s].symbol);
+    REQUIRE(parallel[s].candles.size() == serial[s].candles.size());
+    for (std::size_t i = 0; i < serial[s].candles.size(); ++i) {
+      REQUIRE(parallel[s].candles[i].timestamp == serial[s].candles[i].timestamp);
+      REQUIRE(parallel[s].candles[i].volume == serial[s].candles[i].volume);
+    }
+  }
+  // AAPL is every third row starting at the second.
+  CHECK(serial[0].candles[5].volume == 16.0);
+
+  CHECK(read_symbol_candles_csv(write_temp_csv("lwti_no_symbol.csv",
+                                               "timestamp,open,high,low,close,volume\n"))
+            .empty());
+}
+
+TEST_CASE("sidecar csv index narrows range loads to the indexed window") {
+  std::string csv = "volume,close,ts,low,high,open\n";
+  for (int m = 0; m < 3000; ++m) {
+    const std::string close = std::to_string(100 + m % 13);
+    csv += std::to_string(m) + "," + close + "," + minute_ts(m) + ",90,110," + close + "\n";
+    if (m == 1500) csv += "1,2,not-a-time,3,4,5\n";
+  }
+  const auto path = write_temp_csv("lwti_test_index.csv", csv);
+  const MappedFile file(path);
+  REQUIRE(file.is_open());
+  const CsvIndex index = build_csv_index(file.data(), file.size(), 64);
+  REQUIRE(index.sorted);
+  REQUIRE(index.entries.size() == 47);  // ceil(3000 / 64)
+  REQUIRE(index.entries[1].timestamp == 1704067200 * kNanosPerSecond + 64 * 60 * kNanosPerSecond);
+
+  const auto all = read_candles_csv(path, 1);
+  REQUIRE(all.size() == 3000);
+  const TimeRange range{all[700].timestamp, all[2200].timestamp};
+  const auto [first, last] = index.window(range, file.size());
+  CHECK(last - first < file.size() * 3 / 5);  // the range holds half of the rows
+  for (std::size_t threads : {1, 4}) {
+    const auto slice = read_candles_csv(path, threads, index, range);
+    REQUIRE(slice.size() == 1500);
+    REQUIRE(slice.front().timestamp == all[700].timestamp);
+    REQUIRE(slice.back().volume == 2199.0);
+  }
+  const auto whole = read_candles_csv(path, 4, index, TimeRange{});
+  REQUIRE(whole.size() == all.size());
+  for (std::size_t i = 0; i < all.size(); ++i) {
+    REQUIRE(whole[i].timestamp == all[i].timestamp);
+  }
+
+  const auto index_path = csv_index_path(path);
+  const SourceFingerprint source{file.size(), 1, 2};
+  REQUIRE(write_csv_index(index_path, source, index));
+  const auto reread = read_csv_index(index_path, source);
+  REQUIRE(reread.has_value());
+  CHECK(reread->entries.back().offset == index.entries.back().offset);
+  CHECK_FALSE(read_csv_index(index_path, {file.size() + 1, 1, 2}).has_value());
+
+  // A count whose byte size wraps to zero matches a header-only file.
+  std::filesystem::resize_file(index_path, 64);
+  {
+    std::fstream corrupt(index_path, std::ios::binary | std::ios::in | std::ios::out);
+    corrupt.seekp(48);  // magic, version, endian tag, fingerprint, stride
+    const std::uint64_t bogus_count = std::uint64_t{1} << 60;
+    corrupt.write(reinterpret_cast<const char*>(&bogus_count), sizeof(bogus_count));
+  }
+  CHECK_FALSE(read_csv_index(index_path, source).has_value());
+}
+
+TEST_CASE("dataset partitions by symbol and month and prunes by catalog") {
+  const auto root = (std::filesystem::temp_directory_path() / "lwti_test_dataset").string();
+  std::filesystem::remove_all(root);
+  // Hourly bars from 2024-01-01 to early March.
+  std::vector<SymbolCandles> series{{"AAA", {}}, {"BBB", {}}};
+  for (int h = 0; h < 24 * 70; ++h) {
+    const Timestamp ts = 1704067200 * kNanosPerSecond + Timestamp{h} * 3600 * kNanosPerSecond;
+    series[0].candles.push_back({ts, 10.0, 11.0, 9.0, 10.5, 1.0 * h});
+    series[1].candles.push_back({ts, 20.0, 21.0, 19.0, 20.5, 2.0 * h});
+  }
+  REQUIRE(write_dataset(root, series, 4));
+
+  const auto catalog = read_dataset_catalog(root);
+  REQUIRE(catalog.has_value());
+  REQUIRE(catalog->size() == 6);
+  CHECK((*catalog)[0].symbol == "AAA");
+  CHECK((*catalog)[1].month == CivilMonth{2024, 2});
+  CHECK((*catalog)[1].rows == 29 * 24);
+  CHECK(std::filesystem::exists(dataset_partition_path(root, (*catalog)[5])));
+
+  TimeRange range;
+  REQUIRE(parse_timestamp("2024-02-10T00:00:00Z", range.from));
+  REQUIRE(parse_timestamp("2024-02-11T00:00:00Z", range.to));
+  const auto pruned = prune_partitions(*catalog, {"BBB"}, range);
+  REQUIRE(pruned.size() == 1);
+  CHECK(pruned[0].month == CivilMonth{2024, 2});
+
+  const auto loaded = load_dataset(root, {"BBB"}, range, 2);
+  REQUIRE(loaded.size() == 1);
+  REQUIRE(loaded[0].candles.size() == 24);
+  CHECK(loaded[0].candles.front().timestamp == range.from);
+  CHECK(loaded[0].candles.front().volume == 2.0 * (31 + 9) * 24);
+
+  // Rewriting one symbol keeps the other's partitions.
+  series[0].candles.resize(10);
+  REQUIRE(write_dataset(root, {series[0]}, 1));
+  const auto all = load_dataset(root, {}, {}, 0);
+  REQUIRE(all.size() == 2);
+  CHECK(all[0].candles.size() == 10 + 29 * 24 + 10 * 24);  // January replaced, others kept
+  CHECK(all[1].candles.size() == 24 * 70);
+  CHECK_FALSE(write_dataset(root, {{"a/b", series[0].candles}}, 1));
+
+  // A count whose byte size wraps to zero matches a header-only catalog.
+  const auto catalog_path = dataset_catalog_path(root);
+  std::filesystem::resize_file(catalog_path, 32);
+  {
+    std::fstream corrupt(catalog_path, std::ios::binary | std::ios::in | std::ios::out);
+    corrupt.seekp(16);  // magic, version, endian tag
+    const std::uint64_t bogus_count = std::uint64_t{1} << 58;
+    corrupt.write(reinterpret_cast<const char*>(&bogus_count), sizeof(bogus_count));
+  }
+  CHECK_FALSE(read_dataset_catalog(root).has_value());
+}
+
+TEST_CASE("dataset streams block by block and matches the batch load") {
+  const auto root = (std::filesystem::temp_directory_path() / "lwti_test_dataset_stream").string();
+  std::filesystem::remove_all(root);
+  std::vector<SymbolCandles> series{{"XYZ", {}}};
+  for (int m = 0; m < 60 * 24 * 45; ++m) {  // 45 days of minutes, two partitions
+    const Timestamp ts = 1706659200 * kNanosPerSecond + Timestamp{m} * 60 * kNanosPerSecond;
+    series[0].candles.push_back({ts, 5.0, 6.0, 4.0, 5.0 + (m % 7) * 0.25, 1.0 + m % 11});
+  }
+  REQUIRE(write_dataset(root, series, 2));
+
+  DataConfig config;
+  config.dataset = root;
+  auto sources = open_dataset_sources(config);
+  REQUIRE(sources.size() == 1);
+  CHECK(sources[0].symbol == "XYZ");
+  std::vector<Candle> streamed;
+  std::vector<Candle> batch;
+  std::size_t batches = 0;
+  while (sources[0].source->next(batch)) {
+    streamed.insert(streamed.end(), batch.begin(), batch.end());
+    ++batches;
+  }
+  CHECK(batches > 10);
+  REQUIRE(streamed.size() == series[0].candles.size());
+  for (std::size_t i = 0; i < streamed.size(); ++i) {
+    REQUIRE(streamed[i].timestamp == series[0].candles[i].timestamp);
+    REQUIRE(streamed[i].close == series[0].candles[i].close);
+  }
+
+  // Released pages read back from the file.
+  const MappedFile file(dataset_partition_path(root, read_dataset_catalog(root)->front()));
+  const std::string before(file.view());
+  file.release(0, file.size());
+  CHECK(std::string(file.view()) == before);
+}
@@ -1,7 +1,13 @@
 #define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch_amalgamated.hpp"
 
+#include <cmath>
+
 #include "backtest/backtester.hpp"
+#include "backtest/pipeline.hpp"
+#include "core/candle_series.hpp"
+#include "core/signal_column.hpp"
+#include "core/state_codec.hpp"
 #include "indicators/regime.hpp"
 #include "indicators/vwap_band.hpp"
 #include "strategy/composite_strategy.hpp"
@@ -15,10 +21,10 @@ TEST_CASE("vwap band emits short on breakout") {
   VwapBandIndicator ind(cfg);
 
   std::vector<Candle> candles{
-      {"t1", 100, 101, 99, 100, 10},
-      {"t2", 100, 101, 99, 100, 10},
-      {"t3", 100, 101, 99, 100, 10},
-      {"t4", 103, 104, 102, 103, 10},
+      {1, 100, 101, 99, 100, 10},
+      {2, 100, 101, 99, 100, 10},
+      {3, 100, 101, 99, 100, 10},
+      {4, 103, 104, 102, 103, 10},
   };
 
   auto out = ind.compute(candles);
@@ -30,16 +36,16 @@ TEST_CASE("composite strategy flattens under high volatility regime") {
   CompositeStrategy strat({.lwti_weight = 1.0, .vwap_weight = 1.0, .max_position = 1.0});
 
   std::vector<IndicatorPoint> lwti_points{
-      {0, "t1", 0, 0, 0, Signal::Long},
-      {1, "t2", 0, 0, 0, Signal::Long},
+      {0, 0, 0, Signal::Long},
+      {0, 0, 0, Signal::Long},
   };
   std::vector<VwapBandPoint> vwap_points{
-      {0, "t1", 0, 0, 0, Signal::Long},
-      {1, "t2", 0, 0, 0, Signal::Long},
+      {0, 0, 0, Signal::Long},
+      {0, 0, 0, Signal::Long},
   };
   std::vector<RegimePoint> regimes{
-      {0, "t1", 0.0, VolatilityRegime::Low, Signal::Long},
-      {1, "t2", 0.05, VolatilityRegime::High, Signal::Flat},
+      {0.0, VolatilityRegime::Low, Signal::Long},
+      {0.05, VolatilityRegime::High, Signal::Flat},
   };
 
   auto out = strat.generate(lwti_points, vwap_points, regimes);
@@ -52,15 +58,15 @@ TEST_CASE("composite strategy flattens under high volatility regime") {
 
 TEST_CASE("backtester produces gains on rising market with long bias") {
   std::vector<Candle> candles{
-      {"t1", 100, 101, 99, 100, 10},
-      {"t2", 101, 102, 100, 101, 10},
-      {"t3", 102, 103, 101, 102, 10},
+      {1, 100, 101, 99, 100, 10},
+      {2, 101, 102, 100, 101, 10},
+      {3, 102, 103, 101, 102, 10},
   };
 
   std::vector<StrategyPoint> strategy{
-      {0, "t1", 1.0, 1.0, Signal::Long},
-      {1, "t2", 1.0, 1.0, Signal::Long},
-      {2, "t3", 1.0, 1.0, Signal::Long},
+      {1.0, 1.0, Signal::Long},
+      {1.0, 1.0, Signal::Long},
+      {1.0, 1.0, Signal::Long},
   };
 
   BacktestConfig cfg;
@@ -75,3 +81,228 @@ TEST_CASE("backtester produces gains on rising market with long bias") {
   CHECK(res.ending_equity > res.starting_equity);
   CHECK(res.trades >= 1);
 }
+
+TEST_CASE("candle series runs match the record-based runs") {
+  std::vector<Candle> candles;
+  for (int i = 0; i < 120; ++i) {
+    const double close = 50.0 + 3.0 * std::cos(i * 0.2) + 0.1 * i;
+    candles.push_back({i, close + 0.1, close + 0.7, close - 0.4, close, 5.0 + (i % 7)});
+  }
+  const CandleSeries series(candles);
+  REQUIRE(series.size() == candles.size());
+  CHECK(series[17].high == candles[17].high);
+  CHECK(series.to_candles().back().volume == candles.back().volume);
+
+  const auto lwti_a = LiquidityWeightedTrendIndicator().compute(candles);
+  const auto lwti_b = LiquidityWeightedTrendIndicator().compute(series);
+  const auto vwap_a = VwapBandIndicator().compute(candles);
+  const auto vwap_b = VwapBandIndicator().compute(series);
+  const auto regime_a = VolatilityRegimeIndicator().compute(candles);
+  const auto regime_b = VolatilityRegimeIndicator().compute(series);
+  REQUIRE(lwti_b.size() == candles.size());
+  for (std::size_t i = 0; i < candles.size(); ++i) {
+    REQUIRE(lwti_a[i].momentum == lwti_b[i].momentum);
+    REQUIRE(vwap_a[i].upper == vwap_b[i].upper);
+    REQUIRE(regime_a[i].realized_vol == regime_b[i].realized_vol);
+  }
+
+  const auto strategy = CompositeStrategy().generate(lwti_a, vwap_a, regime_a);
+  const auto run_a = Backtester().run(candles, strategy);
+  const auto run_b = Backtester().run(series, strategy);
+  CHECK(run_a.ending_equity == run_b.ending_equity);
+  CHECK(run_a.trades == run_b.trades);
+}
+
+TEST_CASE("fixed-point backtest keeps equity in whole ticks") {
+  CandleSeries series;
+  for (int i = 0; i < 300; ++i) {
+    const double close = 100.0 + 4.0 * std::sin(i * 0.15) + 0.01 * i;
+    series.push_back({i, close, close + 0.3, close - 0.3, close, 10.0});
+  }
+  const auto strategy = CompositeStrategy().generate(
+      LiquidityWeightedTrendIndicator().compute(series), VwapBandIndicator().compute(series),
+      VolatilityRegimeIndicator().compute(series));
+
+  BacktestConfig cfg;
+  cfg.risk_per_trade = 0.5;
+  cfg.tick_size = 0.01;
+  const auto fixed = to_fixed(series, cfg.tick_size);
+  REQUIRE(fixed);
+  CHECK(fixed->close[1] == std::llround(series.close[1] * 100.0));
+
+  // Closes rounded per bar and a pre-rounded series take the same path.
+  const auto a = Backtester(cfg).run(series, strategy);
+  const auto b = Backtester(cfg).run(*fixed, strategy);
+  REQUIRE(a.trades > 0);
+  CHECK(a.ending_equity == b.ending_equity);
+  CHECK(a.trades == b.trades);
+  const double cents = a.ending_equity * 100.0;
+  CHECK(std::abs(cents - std::round(cents)) < 1e-6);
+  for (const Trade& t : a.trade_log) {
+    CHECK(t.quantity == std::round(t.quantity));
+  }
+
+  // With fine lots the result approaches the double ledger.
+  BacktestConfig fine = cfg;
+  fine.lot_size = 1e-6;
+  cfg.tick_size = 0.0;
+  const double reference = Backtester(cfg).run(series, strategy).ending_equity;
+  const double fine_equity = Backtester(fine).run(series, strategy).ending_equity;
+  CHECK(std::abs(fine_equity - reference) < reference * 1e-4);
+
+  CHECK(Backtester(cfg).fixed_ledger_fits());
+  BacktestConfig huge = fine;
+  huge.tick_size = 1e-9;
+  CHECK_FALSE(Backtester(huge).fixed_ledger_fits());
+
+  series.close[7] = std::nan("");
+  CHECK_FALSE(to_fixed(series, 0.01));
+  CHECK_FALSE(to_fixed(series, 0.0));
+}
+
+TEST_CASE("packed signal column matches per-bar signals") {
+  const Signal cycle[] = {Signal::Long, Signal::Long, Signal::Flat, Signal::Short, Signal::Short,
+                          Signal::Short, Signal::Long};
+  std::vector<Signal> plain;
+  SignalColumn column;
+  for (int i = 0; i < 101; ++i) {  // spans four words, the last one partial
+    plain.push_back(cycle[(i * i) % 7]);
+    column.push_back(plain.back());
+  }
+  REQUIRE(column.size() == plain.size());
+  REQUIRE(column.words().size() == 4);
+
+  SignalCounts expected;
+  std::vector<std::size_t> changes;
+  const auto polarity = column.polarity();
+  for (std::size_t i = 0; i < plain.size(); ++i) {
+    REQUIRE(column[i] == plain[i]);
+    REQUIRE(polarity[i] == signal_polarity(plain[i]));
+    expected.long_bars += plain[i] == Signal::Long;
+    expected.short_bars += plain[i] == Signal::Short;
+    expected.flat_bars += plain[i] == Signal::Flat;
+    if (i > 0 && plain[i] != plain[i - 1]) changes.push_back(i);
+  }
+  const SignalCounts counts = column.counts();
+  CHECK(counts.long_bars == expected.long_bars);
+  CHECK(counts.short_bars == expected.short_bars);
+  CHECK(counts.flat_bars == expected.flat_bars);
+  CHECK(column.transitions() == changes.size());
+  CHECK(column.transition_bars() == changes);
+
+  column.set(100, Signal::Flat);
+  CHECK(column[100] == Signal::Flat);
+  const SignalColumn adopted = SignalColumn::from_words({~0ULL}, 3);
+  CHECK(adopted.counts().flat_bars == 3);
+  CHECK(adopted.words()[0] == 0);
+}
+
+TEST_CASE("composite strategy scores packed signal columns") {
+  std::vector<Candle> candles;
+  for (int i = 0; i < 500; ++i) {
+    const double close = 80.0 + 6.0 * std::sin(i * 0.11) + 2.0 * std::sin(i * 0.7);
+    candles.push_back({i, close, close + 0.4, close - 0.4, close, 10.0 + (i % 5)});
+  }
+  const auto lwti_points = LiquidityWeightedTrendIndicator().compute(candles);
+  const auto vwap_points = VwapBandIndicator().compute(candles);
+  RegimeConfig regime_cfg;
+  regime_cfg.high_vol_threshold = 0.01;
+  const auto regime_points = VolatilityRegimeIndicator(regime_cfg).compute(candles);
+
+  const CompositeStrategy strategy;
+  const auto expected = strategy.generate(lwti_points, vwap_points, regime_points);
+  const SignalColumn lwti = pack_signals(lwti_points);
+  const SignalColumn vwap = pack_signals(vwap_points);
+  const SignalColumn regime = pack_signals(regime_points);
+  REQUIRE(regime.counts().flat_bars > 0);
+
+  const auto packed = strategy.generate(lwti, vwap, regime);
+  REQUIRE(packed.size() == expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    REQUIRE(packed[i].score == expected[i].score);
+    REQUIRE(packed[i].position == expected[i].position);
+    REQUIRE(packed[i].signal == expected[i].signal);
+  }
+  const SignalColumn signals = strategy.signals(lwti, vwap, regime);
+  CHECK(signals.words() == pack_signals(expected).words());
+}
+
+TEST_CASE("span overloads fill caller-owned buffers") {
+  CandleSeries series;
+  for (int i = 0; i < 256; ++i) {
+    const double close = 40.0 + 2.0 * std::sin(i * 0.25) + 0.02 * i;
+    series.push_back({i, close, close + 0.2, close - 0.3, close, 3.0 + (i % 4)});
+  }
+  const std::size_t n = series.size();
+  std::vector<IndicatorPoint> lwti(n);
+  std::vector<VwapBandPoint> vwap(n);
+  std::vector<RegimePoint> regime(n);
+  std::vector<StrategyPoint> strategy(n);
+
+  REQUIRE(LiquidityWeightedTrendIndicator().compute(series.high, series.low, series.close,
+                                                    series.volume, std::span(lwti)) == n);
+  REQUIRE(VwapBandIndicator().compute(series.close, series.volume, std::span(vwap)) == n);
+  REQUIRE(VolatilityRegimeIndicator().compute(series.close, std::span(regime)) == n);
+  REQUIRE(CompositeStrategy().generate(lwti, vwap, regime, std::span(strategy)) == n);
+  // Vectors convert to the column spans directly.
+  const auto result = Backtester().run(series.timestamp, series.close, strategy);
+
+  const auto expected = CompositeStrategy().generate(
+      LiquidityWeightedTrendIndicator().compute(series), VwapBandIndicator().compute(series),
+      VolatilityRegimeIndicator().compute(series));
+  for (std::size_t i = 0; i < n; ++i) {
+    REQUIRE(strategy[i].score == expected[i].score);
+  }
+  CHECK(result.ending_equity == Backtester().run(series, expected).ending_equity);
+
+  std::vector<BasicStrategyPoint<float>> narrow;
+  for (const StrategyPoint& p : strategy) {
+    narrow.push_back({static_cast<float>(p.score), static_cast<float>(p.position), p.signal});
+  }
+  CHECK(Backtester().run(series.timestamp, series.close, narrow).trades == result.trades);
+
+  // A short output span bounds the run and the rest is left untouched.
+  std::vector<RegimePoint> head(10, RegimePoint{-1.0, VolatilityRegime::High, Signal::Short});
+  CHECK(VolatilityRegimeIndicator().compute(series.close, std::span(head).first(4)) == 4);
+  CHECK(head[3].realized_vol == regime[3].realized_vol);
+  CHECK(head[4].realized_vol == -1.0);
+}
+
+TEST_CASE("pipeline resumed from a checkpoint matches an uninterrupted run") {
+  std::vector<Candle> candles;
+  for (int i = 0; i < 200; ++i) {
+    const double close = 100.0 + 5.0 * std::sin(i * 0.3) + 0.05 * i;
+    candles.push_back({i, close - 0.2, close + 0.5, close - 0.6, close, 10.0 + (i % 9)});
+  }
+  RunConfig cfg;
+  cfg.vwap.window = 12;
+
+  Pipeline whole(cfg);
+  Pipeline first(cfg);
+  for (std::size_t i = 0; i < 120; ++i) {
+    whole.update(candles[i]);
+    first.update(candles[i]);
+  }
+  StateWriter out;
+  first.save(out);
+
+  Pipeline resumed(cfg);
+  StateReader in(out.bytes());
+  REQUIRE(resumed.restore(in));
+  REQUIRE(in.at_end());
+  for (std::size_t i = 120; i < candles.size(); ++i) {
+    const auto a = whole.update(candles[i]);
+    const auto b = resumed.update(candles[i]);
+    REQUIRE(a.strategy.signal == b.strategy.signal);
+    REQUIRE(a.lwti.momentum == b.lwti.momentum);
+    REQUIRE(a.vwap.vwap == b.vwap.vwap);
+    REQUIRE(a.strategy.score == b.strategy.score);
+  }
+  REQUIRE(whole.finish().ending_equity == resumed.finish().ending_equity);
+
+  RunConfig other = cfg;
+  other.vwap.window = 13;
+  Pipeline mismatched(other);
+  StateReader again(out.bytes());
+  REQUIRE_FALSE(mismatched.restore(again));
+}